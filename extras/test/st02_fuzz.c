@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+/*
+ * Scheduler fuzzing harness. Threads perform operations driven by a seeded
+ * pseudo-random stream (or fuzzer provided input) and the scheduler
+ * invariants are checked after each operation. Run on the simulation
+ * platform (virtual clock), therefore idle periods pass instantly.
+ *
+ * Usage: st02_fuzz [seed [ops_number]]
+ *
+ * libFuzzer entry point is compiled with COOP_LIBFUZZER defined, e.g.:
+ * clang -fsanitize=fuzzer -DCOOP_LIBFUZZER -DST02 ... st02_fuzz.c <lib-srcs>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "coop_threads.h"
+
+#define SEM_N 4
+#define STACK_SIZE 0x1000U
+
+/* operations stream source: fuzzer input or pseudo-random generator */
+static const uint8_t *in_data = NULL;
+static size_t in_len = 0, in_pos = 0;
+static unsigned long rnd_state = 1;
+
+static unsigned long ops_left = 0, ops_done = 0;
+static unsigned thrd_cnt = 0;
+static unsigned counter = 0;
+
+static unsigned next_byte(void)
+{
+    if (in_data) {
+        if (in_pos >= in_len) {
+            /* input exhausted; finish the scenario */
+            ops_left = 0;
+            return 0;
+        }
+        return in_data[in_pos++];
+    }
+
+    /* LCG; deterministic for a given seed */
+    rnd_state = rnd_state * 1103515245UL + 12345UL;
+    return (unsigned)((rnd_state >> 16) & 0xff);
+}
+
+static void check_invariants(const char *op)
+{
+    const char *err = coop_test_check_invariants();
+
+    if (err) {
+        fprintf(stderr, "Invariant violated after %s (op #%lu): %s\n",
+            op, ops_done, err);
+        abort();
+    }
+}
+
+static bool wait_predic(void *cv)
+{
+    return (counter % SEM_N) == (unsigned)(size_t)cv;
+}
+
+static void thrd_proc(void *arg)
+{
+    coop_tick_t after = coop_tick_cb();
+    const char *op;
+    (void)arg;
+
+    while (ops_left > 0)
+    {
+        ops_left--;
+        ops_done++;
+
+        switch (next_byte() % 12)
+        {
+        case 0:
+            op = "yield";
+            coop_yield();
+            break;
+        case 1:
+            op = "idle";
+            coop_idle(1 + next_byte() % 50);
+            break;
+        case 2:
+            op = "yield_after";
+            coop_sim_advance(next_byte() % 8);
+            coop_yield_after(&after, 1 + next_byte() % 10);
+            break;
+        case 3:
+            op = "wait";
+            coop_wait((int)(next_byte() % SEM_N), 1 + next_byte() % 100);
+            break;
+        case 4:
+            op = "wait_cond";
+            coop_wait_cond((int)(next_byte() % SEM_N), 1 + next_byte() % 100,
+                wait_predic, (void*)(size_t)(next_byte() % SEM_N));
+            break;
+        case 5:
+            op = "notify";
+            coop_notify((int)(next_byte() % SEM_N));
+            break;
+        case 6:
+            op = "notify_all";
+            coop_notify_all((int)(next_byte() % SEM_N));
+            break;
+        case 7:
+            op = "counter";
+            counter++;
+            break;
+        case 8:
+        case 9:
+            /* may fail with the limit error */
+            op = "spawn";
+            coop_sched_thread(thrd_proc, NULL, STACK_SIZE,
+                (void*)(size_t)(++thrd_cnt));
+            break;
+        case 10:
+            op = "exit";
+            /* prefer most shallow threads to exit to not fill up the pool
+               with holes */
+            if (coop_test_is_shallow() || !(next_byte() % 4)) return;
+            break;
+        default:
+            op = "stack_wm";
+            if (coop_stack_wm() > STACK_SIZE) {
+                fprintf(stderr, "Invalid stack water-mark\n");
+                abort();
+            }
+            break;
+        }
+        check_invariants(op);
+    }
+}
+
+static void run_scenario(void)
+{
+    coop_sim_reset(0);
+    counter = 0;
+
+    for (int i = 0; i < CONFIG_MAX_THREADS / 2; i++) {
+        coop_sched_thread(
+            thrd_proc, NULL, STACK_SIZE, (void*)(size_t)(++thrd_cnt));
+    }
+    coop_sched_service();
+}
+
+#ifdef COOP_LIBFUZZER
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    in_data = data;
+    in_len = size;
+    in_pos = 0;
+    ops_left = (unsigned long)-1;
+
+    run_scenario();
+    return 0;
+}
+#else
+int main(int argc, char **argv)
+{
+    struct timespec start, end;
+    double secs;
+    unsigned long seed =
+        (argc > 1 ? strtoul(argv[1], NULL, 0) : (unsigned long)time(NULL));
+
+    ops_left = (argc > 2 ? strtoul(argv[2], NULL, 0) : 1000000UL);
+    rnd_state = seed;
+
+    printf("seed: %lu\n", seed);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* scenario restarted until all operations are performed */
+    while (ops_left > 0) run_scenario();
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    secs = (double)(end.tv_sec - start.tv_sec) +
+        (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("ops: %lu, time: %.3f s, ops/sec: %.0f\n", ops_done, secs,
+        (secs > 0 ? (double)ops_done / secs : 0.0));
+
+    return 0;
+}
+#endif
@@ -11,16 +11,15 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>
 #include "coop_threads.h"
 
 void coop_idle_cb(coop_tick_t period)
 {
-    /* short or infinite periods are ignored */
+    /* short periods are not logged */
     if (period > 1) {
         printf("coop_idle_cb called-back for %lu\n", (unsigned long)period);
-        usleep((useconds_t)period * 1000);
     }
+    coop_sim_idle(period);
 }
 
 void thrd_proc(void *arg)
@@ -39,6 +38,8 @@ void thrd_proc(void *arg)
 
 int main(void)
 {
+    coop_sim_reset(0);
+
     coop_sched_thread(thrd_proc, "thrd_1", 0, (void*)(size_t)100U);
     coop_sched_thread(thrd_proc, "thrd_2", 0, (void*)(size_t)200U);
     coop_sched_thread(thrd_proc, "thrd_3", 0, (void*)(size_t)300U);
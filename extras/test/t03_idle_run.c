@@ -11,16 +11,15 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>
 #include "coop_threads.h"
 
 void coop_idle_cb(coop_tick_t period)
 {
-    /* short or infinite periods are ignored */
+    /* short periods are not logged */
     if (period > 1) {
         printf("coop_idle_cb called-back for %ld\n", (unsigned long)period);
-        usleep((useconds_t)period * 1000U);
     }
+    coop_sim_idle(period);
 }
 
 void thrd_1(void *arg)
@@ -45,7 +44,7 @@ void thrd_2(void *arg)
     for (int i = 0; i < 10; i++)
     {
         printf("%s: %d\n", coop_thread_name(), i+1);
-        usleep(100000);
+        coop_sim_advance(100);
         coop_yield();
     }
 
@@ -57,6 +56,8 @@ void thrd_2(void *arg)
 
 int main(void)
 {
+    coop_sim_reset(0);
+
     coop_sched_thread(thrd_1, "thrd_1", 0, NULL);
     coop_sched_thread(thrd_2, "thrd_2", 0, NULL);
     coop_sched_service();
@@ -11,7 +11,6 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>
 #include "coop_threads.h"
 
 /* max 10 ticks to run the thread before yielding */
@@ -26,7 +25,7 @@ static void thrd_1(void *arg)
     for (int i = 0; i < 10; i++)
     {
         printf("%s: %d\n", coop_thread_name(), i+1);
-        usleep(5000);
+        coop_sim_advance(5);
 
         coop_yield_after(&after, MAX_RUN_TIME);
     }
@@ -46,6 +45,8 @@ static void thrd_2(void *arg)
 
 int main(void)
 {
+    coop_sim_reset(0);
+
     coop_sched_thread(thrd_1, "thrd_1", 0, NULL);
     coop_sched_thread(thrd_2, "thrd_2", 0, NULL);
     coop_sched_service();
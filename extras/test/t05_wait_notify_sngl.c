@@ -11,7 +11,6 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>
 #include "coop_threads.h"
 
 static void thrd_1(void *arg)
@@ -33,7 +32,7 @@ static void thrd_2(void *arg)
 {
     coop_tick_t sleep_time = (coop_tick_t)(size_t)arg;
 
-    usleep(sleep_time * 1000);
+    coop_sim_advance(sleep_time);
     coop_yield();
 
     coop_notify(1);
@@ -43,6 +42,8 @@ static void thrd_2(void *arg)
 
 int main(void)
 {
+    coop_sim_reset(0);
+
     for (unsigned i = 1; i <= 5; i++) {
         coop_sched_thread(thrd_1, "thrd_1", 0, (void*)(size_t)350U);
         coop_sched_thread(thrd_2, "thrd_2", 0, (void*)(size_t)(i * 100U));
@@ -11,7 +11,6 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>
 #include "coop_threads.h"
 
 static void thrd_grp1(void *arg)
@@ -64,6 +63,8 @@ static void thrd_notify(void *arg)
 
 int main(void)
 {
+    coop_sim_reset(0);
+
     coop_sched_thread(thrd_notify, "thrd_notify", 0, NULL);
 
     coop_sched_thread(thrd_grp1, "thrd_grp1_1", 0, (void*)(size_t)100U);
@@ -11,7 +11,6 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>
 #include "coop_threads.h"
 
 void coop_idle_cb(coop_tick_t period)
@@ -19,13 +18,16 @@ void coop_idle_cb(coop_tick_t period)
     static unsigned call_n = 0;
 
     /* short periods are ignored */
-    if (period == 1) return;
+    if (period == 1) {
+        coop_sim_idle(period);
+        return;
+    }
 
     call_n++;
     printf("coop_idle_cb called-back for %lu\n", (unsigned long)period);
 
     if (period) {
-        usleep((useconds_t)period * 1000);
+        coop_sim_idle(period);
         if (call_n == 2) {
             coop_notify(1);
             coop_notify_all(2);
@@ -73,6 +75,8 @@ static void thrd_grp(void *arg)
 
 int main(void)
 {
+    coop_sim_reset(0);
+
     coop_sched_thread(thrd_proc, "thrd_1", 0, (void*)(size_t)100U);
     coop_sched_thread(thrd_proc, "thrd_2", 0, (void*)(size_t)200U);
     coop_sched_thread(thrd_proc, "thrd_3", 0, (void*)(size_t)0);
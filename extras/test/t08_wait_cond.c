@@ -11,7 +11,6 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>
 #include "coop_threads.h"
 
 typedef struct {
@@ -57,6 +56,8 @@ int main(void)
 {
     unsigned counter = 0;
 
+    coop_sim_reset(0);
+
     coop_sched_thread(thrd_notify, "thrd_notify", 0, &counter);
 
     coop_sched_thread(thrd_proc, "thrd_1", 0, &(thrd_arg_t){2U, &counter});
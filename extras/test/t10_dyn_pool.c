@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "coop_threads.h"
+
+#define STACK_SIZE 0x400U
+#define WORKERS_N 39
+
+static unsigned workers = 0;
+
+static void thrd_worker(void *arg)
+{
+    unsigned yields = (unsigned)(size_t)arg;
+
+    for (unsigned i = 0; i < yields; i++) {
+        coop_yield();
+    }
+    workers--;
+}
+
+static void thrd_master(void *arg)
+{
+    unsigned i;
+    (void)arg;
+
+    /* pool extended up to all the scheduled threads */
+    assert(coop_test_get_pool_size() == 40);
+
+    while (workers > 0)
+        coop_yield();
+
+    /* pool shrunk with a single spare chunk left */
+    assert(coop_test_get_pool_size() == 2 * CONFIG_DYN_POOL_CHUNK);
+
+    /* extend the pool up to its limit */
+    for (i = 1; i < CONFIG_MAX_THREADS; i++) {
+        assert(coop_sched_thread(
+            thrd_worker, "worker", STACK_SIZE, (void*)(size_t)1) == COOP_SUCCESS);
+        workers++;
+    }
+    assert(coop_sched_thread(
+        thrd_worker, "worker", STACK_SIZE, NULL) == COOP_ERR_LIMIT);
+    assert(coop_test_get_pool_size() == CONFIG_MAX_THREADS);
+
+    while (workers > 0)
+        coop_yield();
+
+    assert(coop_test_get_pool_size() == 2 * CONFIG_DYN_POOL_CHUNK);
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+int main(void)
+{
+    coop_sched_thread(thrd_master, "master", STACK_SIZE, NULL);
+
+    /* shallower workers exit later, holes are left on the main stack */
+    for (unsigned i = 1; i <= WORKERS_N; i++) {
+        coop_sched_thread(thrd_worker, "worker", STACK_SIZE, (void*)(size_t)i);
+        workers++;
+    }
+    coop_sched_service();
+
+    /* pool released after all threads finished */
+    coop_sched_thread(thrd_worker, "worker", STACK_SIZE, (void*)(size_t)1);
+    assert(coop_test_get_pool_size() == CONFIG_DYN_POOL_CHUNK);
+    coop_sched_service();
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "coop_threads.h"
+
+#define SMALL_STACK_SIZE 0x400U
+
+static bool d_done = false;
+
+static bool is_between(void *p, void *p1, void *p2)
+{
+    return ((p1 < p && p < p2) || (p2 < p && p < p1));
+}
+
+static void thrd_d(void *arg)
+{
+    (void)arg;
+
+    /* placed in thrd_b's hole */
+    assert(coop_test_get_cur_thrd() == 1);
+    assert(!coop_test_is_shallow());
+
+    printf("%s: 1\n", coop_thread_name());
+    coop_yield();
+
+    /* the stack is located between thrd_a and thrd_c stacks */
+    assert(is_between(coop_test_get_stack(1),
+        coop_test_get_stack(0), coop_test_get_stack(2)));
+
+    printf("%s: 2\n", coop_thread_name());
+    coop_yield();
+
+    d_done = true;
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+static void thrd_b(void *arg)
+{
+    (void)arg;
+
+    printf("%s: 1\n", coop_thread_name());
+    coop_yield();
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+static void thrd_c(void *arg)
+{
+    (void)arg;
+    unsigned depth;
+
+    printf("%s: 1\n", coop_thread_name());
+    coop_yield();
+
+    /* thrd_b is a hole now */
+    depth = coop_test_get_depth();
+    assert(coop_sched_thread(
+        thrd_d, "thrd_d", SMALL_STACK_SIZE, NULL) == COOP_SUCCESS);
+
+    /* stack too large for the hole: placed on top of the main stack */
+    assert(coop_sched_thread(
+        thrd_b, "thrd_e", CONFIG_DEFAULT_STACK_SIZE, NULL) == COOP_SUCCESS);
+
+    while (!d_done) {
+        /* thrd_d doesn't increase the main stack depth */
+        assert(coop_test_get_depth() <= depth + 1);
+        coop_yield();
+    }
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+static void thrd_a(void *arg)
+{
+    (void)arg;
+
+    printf("%s: 1\n", coop_thread_name());
+    while (!d_done)
+        coop_yield();
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+int main(void)
+{
+    coop_sched_thread(thrd_a, "thrd_a", 0, NULL);
+    coop_sched_thread(thrd_b, "thrd_b", 0, NULL);
+    coop_sched_thread(thrd_c, "thrd_c", 0, NULL);
+    coop_sched_service();
+
+    return 0;
+}
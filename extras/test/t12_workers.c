@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <stdio.h>
+#include "coop_threads.h"
+
+#define QUEUE_SIZE 3
+#define JOBS_N 8
+
+static coop_workers_t wrks;
+static coop_work_t queue[QUEUE_SIZE];
+
+/* worker processing the last job */
+static coop_thrd_t last_wrk;
+
+static void job_proc(void *arg)
+{
+    unsigned job = (unsigned)(size_t)arg;
+
+    printf("job_%u: start\n", job);
+    if (job % 2) {
+        /* let other workers run */
+        coop_yield();
+    }
+    printf("job_%u: end\n", job);
+
+    if (job == JOBS_N) last_wrk = coop_thread_self();
+}
+
+static void thrd_producer(void *arg)
+{
+    (void)arg;
+
+    for (unsigned i = 1; i <= JOBS_N; i++) {
+        if (coop_submit(&wrks, job_proc, (void*)(size_t)i) != COOP_SUCCESS)
+        {
+            printf("%s: queue full; job_%u waits\n", coop_thread_name(), i);
+            coop_submit_wait(&wrks, job_proc, (void*)(size_t)i, 0);
+        }
+    }
+
+    /* wait for the workers to park */
+    while (wrks.len || wrks.idle_n < 2) coop_yield();
+
+    /* canceled idle worker leaves the pool */
+    coop_cancel(last_wrk);
+    coop_yield();
+    printf("%s: workers after cancel: %u\n", coop_thread_name(),
+        wrks.workers_n);
+
+    coop_workers_stop(&wrks);
+    printf("%s: submit after stop: %d\n", coop_thread_name(),
+        coop_submit(&wrks, job_proc, NULL));
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+int main(void)
+{
+    coop_workers_init(&wrks, queue, QUEUE_SIZE, 1, 2, "worker", 0);
+    coop_sched_thread(thrd_producer, "producer", 0, NULL);
+    coop_sched_service();
+
+    printf("workers: %u\n", wrks.workers_n);
+    return 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <stdio.h>
+#include "coop_threads.h"
+
+static coop_tick_t start;
+static coop_timer_t tm_periodic, tm_oneshot;
+
+void coop_idle_cb(coop_tick_t period)
+{
+    /* short periods are not logged */
+    if (period > 1) {
+        printf("coop_idle_cb called-back for %lu\n", (unsigned long)period);
+    }
+    coop_sim_idle(period);
+}
+
+static void timer_cb(void *arg)
+{
+    printf("%s: %lu\n", (const char*)arg,
+        (unsigned long)(coop_tick_cb() - start));
+}
+
+static void thrd_proc(void *arg)
+{
+    (void)arg;
+
+    coop_idle(350);
+    printf("%s: %lu\n", coop_thread_name(),
+        (unsigned long)(coop_tick_cb() - start));
+
+    coop_timer_stop(&tm_periodic);
+    coop_timer_start(&tm_oneshot, 300, false, timer_cb, "oneshot_2");
+
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+int main(void)
+{
+    coop_sim_reset(0);
+    start = coop_tick_cb();
+
+    coop_timer_start(&tm_periodic, 100, true, timer_cb, "periodic");
+    coop_timer_start(&tm_oneshot, 250, false, timer_cb, "oneshot_1");
+    coop_sched_thread(thrd_proc, "thrd", 0, NULL);
+    coop_sched_service();
+
+    printf("scheduler exit: %lu\n", (unsigned long)(coop_tick_cb() - start));
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include "coop_threads.h"
+
+#define QUANTUM 10
+
+static bool calc_done = false;
+static unsigned other_runs = 0;
+
+/* time-consuming thread yielding on its quantum expiration */
+static void thrd_calc(void *arg)
+{
+    (void)arg;
+
+    for (int i = 0; i < 25; i++) {
+        coop_sim_advance(2);
+        coop_yield_check();
+    }
+    calc_done = true;
+}
+
+static void thrd_other(void *arg)
+{
+    (void)arg;
+
+    while (!calc_done) {
+        other_runs++;
+        coop_yield();
+    }
+
+    /* quantum expired 5 times during the calc thread's 50 ticks run */
+    assert(other_runs == 5);
+}
+
+/* thread not yielding within its quantum */
+static void thrd_slow(void *arg)
+{
+    (void)arg;
+
+    assert(coop_thread_overruns() == 0);
+
+    coop_sim_advance(4 * QUANTUM);
+    coop_yield();
+    assert(coop_thread_overruns() == 1);
+
+    coop_yield();
+    assert(coop_thread_overruns() == 1);
+}
+
+int main(void)
+{
+    coop_thrd_attr_t attr = {0};
+
+    coop_sim_reset(0);
+
+    attr.quantum = QUANTUM;
+    coop_sched_thread_ex(thrd_calc, "calc", &attr, NULL);
+    coop_sched_thread_ex(thrd_other, "other", NULL, NULL);
+    coop_sched_thread_ex(thrd_slow, "slow", &attr, NULL);
+    coop_sched_service();
+
+    return 0;
+}
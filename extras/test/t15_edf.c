@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <stdio.h>
+#include "coop_threads.h"
+
+static void thrd(void *arg)
+{
+    (void)arg;
+
+    printf("%s: run\n", coop_thread_name());
+    coop_yield();
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+/* thread missing its deadline */
+static void thrd_late(void *arg)
+{
+    (void)arg;
+
+    printf("%s: run\n", coop_thread_name());
+    coop_sim_advance(10);
+
+    /* job completed after its deadline */
+    coop_idle(10);
+    printf("%s: misses %u\n", coop_thread_name(), coop_thread_dl_misses());
+
+    /* no deadline applied */
+    coop_set_deadline(0);
+    coop_idle(10);
+    printf("%s: misses %u\n", coop_thread_name(), coop_thread_dl_misses());
+}
+
+static void sched(const char *name, coop_tick_t deadline)
+{
+    coop_thrd_attr_t attr = {0};
+
+    attr.deadline = deadline;
+    coop_sched_thread_ex(thrd, name, &attr, NULL);
+}
+
+int main(void)
+{
+    coop_thrd_attr_t attr = {0};
+
+    coop_sim_reset(0);
+
+    sched("dl_30", 30);
+    sched("no_dl", 0);
+    sched("dl_20", 20);
+    sched("dl_10", 10);
+
+    attr.deadline = 5;
+    coop_sched_thread_ex(thrd_late, "late", &attr, NULL);
+
+    coop_sched_service();
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <stdio.h>
+#include "coop_threads.h"
+
+#define SEM_PKT 1
+#define SEM_CFG 2
+#define SEM_OTHER 3
+
+/* events dispatching thread */
+static void thrd_disp(void *arg)
+{
+    static const int sem_ids[] = {SEM_PKT, SEM_CFG};
+    static const char *names[] = {"packet", "config"};
+    unsigned which;
+    (void)arg;
+
+    while (coop_wait_any(sem_ids, 2, 100, &which) == COOP_SUCCESS) {
+        printf("%s: %s event\n", coop_thread_name(), names[which]);
+    }
+    printf("%s: time-out\n", coop_thread_name());
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+static void thrd_src(void *arg)
+{
+    (void)arg;
+
+    coop_notify(SEM_CFG);
+    coop_yield();
+    coop_notify(SEM_PKT);
+    coop_yield();
+
+    /* not awaited by the dispatcher */
+    coop_notify(SEM_OTHER);
+    coop_yield();
+
+    coop_notify(SEM_PKT);
+    coop_yield();
+
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+int main(void)
+{
+    coop_sched_thread(thrd_disp, "disp", 0, NULL);
+    coop_sched_thread(thrd_src, "src", 0, NULL);
+    coop_sched_service();
+
+    return 0;
+}
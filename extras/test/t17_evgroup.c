@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <stdio.h>
+#include "coop_threads.h"
+
+#define EV_A 0x01U
+#define EV_B 0x02U
+#define EV_C 0x04U
+
+static coop_evgroup_t grp = COOP_EVGROUP_INIT;
+static coop_evgroup_t grp_isr = COOP_EVGROUP_INIT;
+
+static void thrd_all(void *arg)
+{
+    unsigned bits;
+    (void)arg;
+
+    if (coop_evgroup_wait(
+        &grp, EV_A | EV_B, true, true, 0, &bits) == COOP_SUCCESS)
+    {
+        printf("%s: bits 0x%x\n", coop_thread_name(), bits);
+    }
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+static void thrd_any(void *arg)
+{
+    unsigned bits;
+    (void)arg;
+
+    while (coop_evgroup_wait(
+        &grp, EV_B | EV_C, false, false, 100, &bits) == COOP_SUCCESS)
+    {
+        printf("%s: bits 0x%x\n", coop_thread_name(), bits);
+        coop_evgroup_clear(&grp, EV_C);
+    }
+    printf("%s: time-out; bits 0x%x\n", coop_thread_name(), bits);
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+static void thrd_src(void *arg)
+{
+    (void)arg;
+
+    coop_evgroup_set(&grp, EV_A);
+    printf("%s: set A\n", coop_thread_name());
+    coop_yield();
+
+    coop_evgroup_set(&grp, EV_C);
+    printf("%s: set C\n", coop_thread_name());
+    coop_yield();
+
+    /* both waiters woken; A and B cleared on thrd_all's wait exit */
+    coop_evgroup_set(&grp, EV_B);
+    printf("%s: set B\n", coop_thread_name());
+    coop_yield();
+
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+/* ISR setting the bits after the waiter registered but before it's parked */
+static void isr_switch_out(unsigned thrd)
+{
+    (void)thrd;
+    coop_evgroup_set(&grp_isr, EV_A);
+}
+
+static void thrd_isr(void *arg)
+{
+    static const coop_hooks_t hooks = { NULL, isr_switch_out };
+    unsigned bits;
+    (void)arg;
+
+    coop_set_hooks(&hooks);
+    if (coop_evgroup_wait(
+        &grp_isr, EV_A, true, true, 100, &bits) == COOP_SUCCESS)
+    {
+        printf("%s: bits 0x%x\n", coop_thread_name(), bits);
+    }
+    coop_set_hooks(NULL);
+
+    printf("%s: left bits 0x%x\n", coop_thread_name(), grp_isr.bits);
+    printf("%s EXIT\n", coop_thread_name());
+}
+
+int main(void)
+{
+    coop_sched_thread(thrd_all, "all", 0, NULL);
+    coop_sched_thread(thrd_any, "any", 0, NULL);
+    coop_sched_thread(thrd_src, "src", 0, NULL);
+    coop_sched_service();
+
+    coop_sched_thread(thrd_isr, "isr", 0, NULL);
+    coop_sched_service();
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include "coop_threads.h"
+
+#define WAITERS_N 3
+
+static unsigned counter = 0;
+static unsigned predic_calls = 0;
+static unsigned woken = 0;
+static bool in_notify = false;
+
+static bool wait_predic(void *cv)
+{
+    /* not evaluated by the notifying routine */
+    assert(!in_notify);
+
+    predic_calls++;
+    return (counter >= *(unsigned*)cv);
+}
+
+static void thrd_wait(void *arg)
+{
+    if (coop_wait_cond(1, 0, wait_predic, arg) == COOP_SUCCESS) woken++;
+}
+
+static void thrd_notify(void *arg)
+{
+    (void)arg;
+
+    coop_yield();
+    assert(!woken);
+
+    /* predicate not satisfied */
+    in_notify = true;
+    coop_notify_all(1);
+    in_notify = false;
+
+    coop_yield();
+    assert(predic_calls == 1 && !woken);
+
+    /* single notify wakes a single waiter */
+    counter++;
+    in_notify = true;
+    coop_notify(1);
+    in_notify = false;
+
+    coop_yield();
+    assert(predic_calls == 2 && woken == 1);
+
+    /* predicate shared by the waiters evaluated once */
+    in_notify = true;
+    coop_notify_all(1);
+    in_notify = false;
+
+    coop_yield();
+    assert(predic_calls == 3 && woken == WAITERS_N);
+
+    /* back-to-back single notifies wake two waiters */
+    coop_yield();
+    counter++;
+    in_notify = true;
+    coop_notify(1);
+    coop_notify(1);
+    in_notify = false;
+
+    coop_yield();
+    assert(predic_calls == 4 && woken == WAITERS_N + 2);
+
+    /* notification sent before the wait doesn't wake the thread */
+    coop_notify(2);
+    assert(coop_wait(2, 10) == COOP_ERR_TIMEOUT);
+
+    /* the remaining waiter; lost notification (queue overflow) is handled by
+       the scheduler with no predicates evaluated by the notifying routine */
+    in_notify = true;
+    coop_notify(3);
+    coop_notify(4);
+    coop_notify(1);
+    in_notify = false;
+    coop_yield();
+    assert(woken == WAITERS_N + 3);
+}
+
+static void thrd_wait2(void *arg)
+{
+    /* started once the first batch of waiters has been woken-up */
+    while (woken < WAITERS_N) coop_yield();
+
+    if (coop_wait_cond(1, 0, wait_predic, arg) == COOP_SUCCESS) woken++;
+}
+
+int main(void)
+{
+    static unsigned thrshld = 1, thrshld2 = 2;
+
+    for (unsigned i = 0; i < WAITERS_N; i++) {
+        coop_sched_thread(thrd_wait, "thrd_wait", 0, &thrshld);
+    }
+    for (unsigned i = 0; i < 3; i++) {
+        coop_sched_thread(thrd_wait2, "thrd_wait2", 0, &thrshld2);
+    }
+    coop_sched_thread(thrd_notify, "thrd_notify", 0, NULL);
+    coop_sched_service();
+
+    assert(woken == WAITERS_N + 3);
+
+    return 0;
+}
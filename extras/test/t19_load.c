@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "coop_threads.h"
+
+/* sliding-window span: 8 buckets x 125 ticks */
+#define WINDOW 1000U
+
+static void thrd_proc(void *arg)
+{
+    coop_load_stats_t stats;
+    coop_load_t load;
+    (void)arg;
+
+    /* fill the window with idle time */
+    coop_idle(WINDOW);
+
+    coop_load_stats(&stats);
+    assert(stats.idle_n == 1 && !stats.idle_inf_n);
+    assert(stats.idle_req_ticks == WINDOW);
+    assert(stats.idle_fin_ticks == WINDOW);
+    assert(stats.idle_ticks == WINDOW);
+
+    /* busy run for a quarter of the window */
+    coop_sim_advance(WINDOW / 4);
+    coop_yield();
+
+    coop_cpu_load(&load);
+    printf("busy: %u, threads: %u, scheduler: %u\n",
+        load.busy, load.thrds, load.sched);
+
+    /* the window ends at a bucket boundary (7 full buckets; 875 ticks) */
+    assert(load.busy >= 285 && load.busy <= 286);
+    assert(load.thrds == 285);
+    assert(load.sched == load.busy - load.thrds);
+
+    coop_load_stats(&stats);
+    assert(stats.run_ticks == WINDOW / 4);
+}
+
+int main(void)
+{
+    coop_load_stats_t stats;
+
+    coop_sim_reset(0);
+
+    coop_sched_thread(thrd_proc, "thrd", 0, NULL);
+    coop_sched_service();
+
+    /* statistics survive the scheduler exit */
+    coop_load_stats(&stats);
+    assert(stats.idle_n == 1);
+
+    coop_load_stats_reset();
+    coop_load_stats(&stats);
+    assert(!stats.idle_n && !stats.run_ticks);
+
+    return 0;
+}
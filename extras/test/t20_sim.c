@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <stdio.h>
+#include "coop_threads.h"
+
+/* virtual ticks in msecs */
+#define HOUR (60UL * 60 * 1000)
+
+static void ev_notify(void *arg)
+{
+    (void)arg;
+
+    printf("event at %lu\n", (unsigned long)coop_tick_cb());
+    coop_notify(1);
+}
+
+/* simulated day of hourly activity */
+static void thrd_periodic(void *arg)
+{
+    (void)arg;
+
+    for (int i = 0; i < 24; i++) {
+        /* busy work */
+        coop_sim_advance(1000);
+        coop_idle(HOUR);
+    }
+    printf("%s: tick %lu\n", coop_thread_name(), (unsigned long)coop_tick_cb());
+}
+
+static void thrd_waiter(void *arg)
+{
+    (void)arg;
+
+    for (int i = 0; i < 2; i++) {
+        if (coop_wait(1, 0) == COOP_SUCCESS) {
+            printf("%s: notified at %lu\n",
+                coop_thread_name(), (unsigned long)coop_tick_cb());
+        }
+    }
+
+    if (coop_wait(1, 1000) == COOP_ERR_TIMEOUT) {
+        printf("%s: time-out at %lu\n",
+            coop_thread_name(), (unsigned long)coop_tick_cb());
+    }
+}
+
+int main(void)
+{
+    coop_sim_reset(0);
+    coop_sim_event(HOUR / 2, ev_notify, NULL);
+    coop_sim_event(3 * HOUR / 2, ev_notify, NULL);
+
+    coop_sched_thread(thrd_periodic, "periodic", 0, NULL);
+    coop_sched_thread(thrd_waiter, "waiter", 0, NULL);
+    coop_sched_service();
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "coop_threads.h"
+
+#define STACK_SZ    0x1000U
+#define DEEP_SZ     0x200U
+
+typedef struct
+{
+    unsigned n;
+    const coop_stack_prof_t *deep;
+    const coop_stack_prof_t *shallow;
+    const coop_stack_prof_t *sampler;
+    const coop_stack_prof_t *nodata;
+} recs_t;
+
+static void deep_func(void)
+{
+    volatile unsigned char buf[DEEP_SZ];
+
+    memset((void*)buf, 0, sizeof(buf));
+    coop_yield();
+}
+
+static void deep_proc(void *arg)
+{
+    (void)arg;
+    coop_yield();
+    deep_func();
+}
+
+static void shallow_proc(void *arg)
+{
+    (void)arg;
+    coop_yield();
+}
+
+static void nop_proc(void *arg)
+{
+    (void)arg;
+}
+
+static void sampler_proc(void *arg)
+{
+    (void)arg;
+    coop_yield();
+    /* deep threads are yielding from inside deep_func() */
+    coop_stack_prof_sample();
+}
+
+static void recs_cb(const coop_stack_prof_t *prof, void *arg)
+{
+    recs_t *recs = (recs_t*)arg;
+
+    recs->n++;
+    if (!prof->name) {
+        assert(prof->proc == shallow_proc);
+        recs->shallow = prof;
+    } else if (!strcmp(prof->name, "deep")) {
+        recs->deep = prof;
+    } else if (!strcmp(prof->name, "sampler")) {
+        recs->sampler = prof;
+    } else if (!strcmp(prof->name, "thrd_1")) {
+        recs->nodata = prof;
+    }
+}
+
+static void check_recommend(const coop_stack_prof_t *prof)
+{
+    size_t sz = coop_stack_prof_recommend(prof);
+
+    assert(sz >= prof->wm + CONFIG_STACK_PROF_MARGIN);
+    assert(sz < prof->wm + CONFIG_STACK_PROF_MARGIN + 0x10);
+    assert(!(sz & 0xf));
+}
+
+int main(void)
+{
+    recs_t recs = {0};
+
+    coop_sched_thread(deep_proc, "deep", STACK_SZ, NULL);
+    coop_sched_thread(deep_proc, "deep", STACK_SZ, NULL);
+    coop_sched_thread(shallow_proc, NULL, STACK_SZ / 2, NULL);
+    coop_sched_thread(sampler_proc, "sampler", STACK_SZ, NULL);
+    coop_sched_service();
+
+    coop_stack_prof_foreach(recs_cb, &recs);
+    assert(recs.n == 3);
+    assert(recs.deep && recs.shallow && recs.sampler);
+
+    /* 2 threads sampled on termination and by the sampler */
+    assert(recs.deep->samples == 4);
+    assert(recs.deep->stack_sz == STACK_SZ);
+    assert(recs.deep->wm >= DEEP_SZ && recs.deep->wm <= STACK_SZ);
+    check_recommend(recs.deep);
+
+    /* terminated before sampling */
+    assert(recs.shallow->samples == 1);
+    assert(recs.shallow->stack_sz == STACK_SZ / 2);
+    assert(recs.shallow->wm < DEEP_SZ);
+    check_recommend(recs.shallow);
+
+    /*
+     * Sampled itself and on termination. Note the water-mark may be affected
+     * by the dynamic linker resolving strcmp() on the thread stack.
+     */
+    assert(recs.sampler->samples == 2);
+    assert(recs.sampler->wm <= STACK_SZ);
+    check_recommend(recs.sampler);
+
+    coop_stack_prof_dump(printf);
+
+    /* records exceeding the profile capacity are dropped */
+    coop_stack_prof_reset();
+    /* terminated without yielding; no water-mark */
+    coop_sched_thread(nop_proc, "thrd_1", STACK_SZ, NULL);
+    coop_sched_thread(shallow_proc, "thrd_2", STACK_SZ, NULL);
+    coop_sched_thread(shallow_proc, "thrd_3", STACK_SZ, NULL);
+    coop_sched_thread(shallow_proc, "thrd_4", STACK_SZ, NULL);
+    coop_sched_service();
+
+    memset(&recs, 0, sizeof(recs));
+    coop_stack_prof_foreach(recs_cb, &recs);
+    assert(recs.n == CONFIG_STACK_PROF_ENTRIES);
+
+    assert(recs.nodata && !recs.nodata->samples && !recs.nodata->wm);
+    assert(coop_stack_prof_recommend(recs.nodata) == STACK_SZ);
+
+    return 0;
+}
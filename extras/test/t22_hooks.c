@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "coop_threads.h"
+
+#define MAX_EVENTS  32
+
+/* events are recorded and printed after the scheduler exits, since the hooks
+   may be called on the threads stacks */
+static struct {
+    const char *type;
+    const char *name;
+} events[MAX_EVENTS];
+
+static unsigned events_n;
+static unsigned switch_in_n;
+
+static const coop_hooks_t *prev_hooks;
+
+static void record(const char *type, const char *name)
+{
+    assert(events_n < MAX_EVENTS);
+    events[events_n].type = type;
+    events[events_n].name = name;
+    events_n++;
+}
+
+static void switch_in(unsigned thrd)
+{
+    (void)thrd;
+    record("switch-in", coop_thread_name());
+}
+
+static void switch_out(unsigned thrd)
+{
+    (void)thrd;
+    record("switch-out", coop_thread_name());
+}
+
+static void spawn(unsigned thrd)
+{
+    (void)thrd;
+    record("spawn", coop_thread_name());
+}
+
+static void terminate(unsigned thrd)
+{
+    (void)thrd;
+    record("terminate", coop_thread_name());
+}
+
+static void idle_enter(coop_tick_t period)
+{
+    record("idle-enter", period ? "finite" : "infinite");
+}
+
+static void idle_exit(void)
+{
+    record("idle-exit", NULL);
+}
+
+static const coop_hooks_t tracer = {
+    switch_in, switch_out, spawn, terminate, idle_enter, idle_exit
+};
+
+/* counting hook chained to the tracer */
+static void switch_in_cnt(unsigned thrd)
+{
+    switch_in_n++;
+    if (prev_hooks && prev_hooks->switch_in) prev_hooks->switch_in(thrd);
+}
+
+static coop_hooks_t counter;
+
+static void thrd_proc(void *arg)
+{
+    (void)arg;
+    coop_idle(10);
+}
+
+static void exit_proc(void *arg)
+{
+    (void)arg;
+}
+
+int main(void)
+{
+    unsigned i;
+
+    assert(coop_set_hooks(&tracer) == NULL);
+
+    /* the other hooks are inherited from the tracer */
+    counter = tracer;
+    counter.switch_in = switch_in_cnt;
+    prev_hooks = coop_set_hooks(&counter);
+    assert(prev_hooks == &tracer);
+
+    coop_sched_thread(thrd_proc, "thrd_1", 0, NULL);
+    coop_sched_thread(exit_proc, "thrd_2", 0, NULL);
+    coop_sched_service();
+
+    assert(coop_set_hooks(NULL) == &counter);
+    assert(switch_in_n == 3);
+
+    for (i = 0; i < events_n; i++) {
+        if (events[i].name) {
+            printf("%s %s\n", events[i].type, events[i].name);
+        } else {
+            printf("%s\n", events[i].type);
+        }
+    }
+    return 0;
+}
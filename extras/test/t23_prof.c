@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "coop_threads.h"
+
+#define LOOPS   10
+
+static void busy_wait(coop_tick_t ticks)
+{
+    coop_tick_t start = coop_tick_cb();
+    while (coop_tick_cb() - start < ticks);
+}
+
+/* arg: busy time per loop */
+static void thrd_proc(void *arg)
+{
+    unsigned i;
+
+    for (i = 0; i < LOOPS; i++) {
+        busy_wait((coop_tick_t)(size_t)arg);
+        coop_yield();
+    }
+}
+
+/* get number of samples of a thread from the flat profile */
+static unsigned thrd_samples(FILE *f, const char *name)
+{
+    char ln[128], label[64];
+    unsigned n;
+
+    rewind(f);
+    while (fgets(ln, sizeof(ln), f)) {
+        if (sscanf(ln, "%63s %u", label, &n) == 2 && !strcmp(label, name))
+            return n;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    static const coop_hooks_t hooks = {0};
+    const coop_hooks_t *prev_hooks;
+    unsigned busy_1, busy_2, dropped;
+    FILE *f = tmpfile();
+
+    assert(f);
+    assert(coop_prof_start(0) == COOP_ERR_INV_ARG);
+    assert(coop_prof_start(1000) == COOP_SUCCESS);
+    assert(coop_prof_start(1000) == COOP_ERR_LIMIT);
+
+    coop_sched_thread(thrd_proc, "busy_1", 0, (void*)(size_t)30);
+    coop_sched_thread(thrd_proc, "busy_2", 0, (void*)(size_t)10);
+    coop_sched_service();
+
+    /* hooks chained to the profiler ones are to be uninstalled first */
+    prev_hooks = coop_set_hooks(&hooks);
+    assert(coop_prof_stop() == COOP_ERR_LIMIT);
+    assert(coop_set_hooks(prev_hooks) == &hooks);
+
+    assert(coop_prof_stop() == COOP_SUCCESS);
+    /* profiler hooks uninstalled */
+    assert(coop_set_hooks(NULL) == NULL);
+    assert(coop_prof_stop() == COOP_SUCCESS);
+
+    assert(coop_prof_samples(&dropped) > 0);
+    assert(!dropped);
+
+    assert(!coop_prof_dump(fileno(f), COOP_PROF_FLAT));
+    busy_1 = thrd_samples(f, "busy_1");
+    busy_2 = thrd_samples(f, "busy_2");
+
+    /* CPU time spent by the threads is 3:1 */
+    assert(busy_2 > 0);
+    assert(busy_1 > 2 * busy_2);
+
+    assert(!coop_prof_dump(STDOUT_FILENO, COOP_PROF_COLLAPSED));
+
+    coop_prof_reset();
+    assert(!coop_prof_samples(NULL));
+
+    fclose(f);
+    return 0;
+}
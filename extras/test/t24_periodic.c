@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include "coop_threads.h"
+
+#define PERIOD  10
+
+static void thrd_proc(void *arg)
+{
+    int i;
+    coop_periodic_t per;
+    (void)arg;
+
+    /* already reached tick; acts as yield */
+    coop_idle_until(0);
+    assert(coop_tick_cb() == 0);
+
+    coop_periodic_init(&per, PERIOD);
+
+    /* the cycle work doesn't cause drift */
+    for (i = 1; i <= 5; i++) {
+        assert(!coop_periodic_wait(&per, true));
+        assert(coop_tick_cb() == (coop_tick_t)(i * PERIOD));
+        coop_sim_advance(3);
+    }
+
+    /* overrun with skipped releases at 60, 70 */
+    coop_sim_advance(22);
+    assert(coop_tick_cb() == 75);
+    assert(coop_periodic_wait(&per, true) == 2);
+    assert(coop_tick_cb() == 80);
+
+    /* overrun with catch-up; release at 90 missed */
+    coop_sim_advance(15);
+    assert(coop_periodic_wait(&per, false) == 1);
+    assert(coop_tick_cb() == 95);
+
+    /* back on the period boundaries */
+    assert(!coop_periodic_wait(&per, false));
+    assert(coop_tick_cb() == 100);
+
+    /* finished exactly at the release time */
+    coop_sim_advance(PERIOD);
+    assert(!coop_periodic_wait(&per, true));
+    assert(coop_tick_cb() == 110);
+
+    assert(per.overruns == 2);
+
+    /* absolute wake-up time */
+    coop_idle_until(125);
+    assert(coop_tick_cb() == 125);
+}
+
+int main(void)
+{
+    coop_sim_reset(0);
+    coop_sched_thread(thrd_proc, "periodic", 0, NULL);
+    coop_sched_service();
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include "coop_threads.h"
+
+#define SEM_ID  1
+
+static coop_thrd_t h_bulk, h_keep, h_frozen, h_waiter, h_self;
+
+static unsigned bulk_cnt;
+static coop_tick_t keep_wake, frozen_wake, waiter_wake, self_wake;
+
+#define CHECK_INVARIANTS() assert(!coop_test_check_invariants())
+
+/* keeps the system busy; the virtual clock is not advanced while running */
+static void thrd_bulk(void *arg)
+{
+    (void)arg;
+    while (bulk_cnt < 1000) {
+        bulk_cnt++;
+        coop_yield();
+    }
+}
+
+static void thrd_keep(void *arg)
+{
+    (void)arg;
+    coop_idle(100);
+    keep_wake = coop_tick_cb();
+}
+
+static void thrd_frozen(void *arg)
+{
+    (void)arg;
+    coop_idle(100);
+    frozen_wake = coop_tick_cb();
+}
+
+static void thrd_waiter(void *arg)
+{
+    (void)arg;
+    assert(coop_wait(SEM_ID, 0) == COOP_SUCCESS);
+    waiter_wake = coop_tick_cb();
+}
+
+static void thrd_self(void *arg)
+{
+    (void)arg;
+    h_self = coop_thread_self();
+
+    /* parked at the yield point */
+    assert(coop_suspend(h_self, false) == COOP_SUCCESS);
+    coop_yield();
+    self_wake = coop_tick_cb();
+}
+
+static void thrd_ctrl(void *arg)
+{
+    unsigned cnt;
+    coop_thrd_t inv = {0, 0};
+    (void)arg;
+
+    assert(coop_suspend(inv, false) == COOP_ERR_INV_ARG);
+
+    /* let the threads start */
+    coop_yield();
+    CHECK_INVARIANTS();
+
+    /* suspended running thread is not dispatched */
+    assert(coop_suspend(h_bulk, false) == COOP_SUCCESS);
+    assert(coop_suspend(h_bulk, false) == COOP_SUCCESS);
+    cnt = bulk_cnt;
+    coop_yield();
+    coop_yield();
+    assert(bulk_cnt == cnt);
+
+    /* keep vs freeze of pending idle time-outs (due at 100) */
+    assert(coop_suspend(h_keep, false) == COOP_SUCCESS);
+    assert(coop_suspend(h_frozen, true) == COOP_SUCCESS);
+
+    /* suspended waiter doesn't receive notifications */
+    assert(coop_suspend(h_waiter, false) == COOP_SUCCESS);
+    coop_notify(SEM_ID);
+    CHECK_INVARIANTS();
+
+    /* suspended threads don't wake the system up */
+    coop_idle(200);
+    assert(coop_tick_cb() == 200);
+    assert(!keep_wake && !frozen_wake && !waiter_wake && !self_wake);
+    assert(bulk_cnt == cnt);
+    CHECK_INVARIANTS();
+
+    assert(coop_resume(h_bulk) == COOP_SUCCESS);
+    assert(coop_resume(h_bulk) == COOP_SUCCESS);
+    assert(coop_resume(h_keep) == COOP_SUCCESS);
+    assert(coop_resume(h_frozen) == COOP_SUCCESS);
+    assert(coop_resume(h_waiter) == COOP_SUCCESS);
+    coop_notify(SEM_ID);
+    assert(coop_resume(h_self) == COOP_SUCCESS);
+    CHECK_INVARIANTS();
+
+    coop_yield();
+    assert(bulk_cnt == cnt + 1);
+    assert(keep_wake == 200);
+    assert(waiter_wake == 200);
+    assert(self_wake == 200);
+
+    /* stop the bulk thread */
+    bulk_cnt = 1000;
+
+    /* frozen 100 ticks remained at the suspension time */
+    coop_idle(100);
+    assert(frozen_wake == 300);
+
+    /* handles of terminated threads are invalid */
+    assert(coop_suspend(h_keep, false) == COOP_ERR_INV_ARG);
+    assert(coop_resume(h_self) == COOP_ERR_INV_ARG);
+}
+
+int main(void)
+{
+    coop_sim_reset(0);
+
+    coop_sched_thread_ex(thrd_ctrl, "ctrl", NULL, NULL);
+    coop_sched_thread_h(thrd_bulk, "bulk", NULL, NULL, &h_bulk);
+    coop_sched_thread_h(thrd_keep, "keep", NULL, NULL, &h_keep);
+    coop_sched_thread_h(thrd_frozen, "frozen", NULL, NULL, &h_frozen);
+    coop_sched_thread_h(thrd_waiter, "waiter", NULL, NULL, &h_waiter);
+    coop_sched_thread_ex(thrd_self, "self", NULL, NULL);
+    coop_sched_service();
+
+    CHECK_INVARIANTS();
+    return 0;
+}
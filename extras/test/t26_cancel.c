@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include "coop_threads.h"
+
+#define SEM_ID  1
+
+static coop_thrd_t h_run, h_idle, h_wait, h_new, h_reuse;
+static coop_evgroup_t evg = COOP_EVGROUP_INIT;
+
+static unsigned run_cnt;
+static bool idle_done, wait_done, new_started, wait_pend;
+static coop_error_t wait_ret = COOP_SUCCESS;
+static coop_error_t reuse_ret = COOP_ERR_TIMEOUT;
+
+#define CHECK_INVARIANTS() assert(!coop_test_check_invariants())
+
+static void thrd_run(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        run_cnt++;
+        coop_yield();
+    }
+}
+
+static void thrd_idle(void *arg)
+{
+    (void)arg;
+    coop_idle(1000);
+    idle_done = true;
+}
+
+static void thrd_wait(void *arg)
+{
+    (void)arg;
+    wait_ret = coop_wait(SEM_ID, 0);
+    wait_pend = coop_cancel_pending();
+
+    /* cancellation point */
+    coop_yield();
+    wait_done = true;
+}
+
+static void thrd_new(void *arg)
+{
+    (void)arg;
+    new_started = true;
+}
+
+static void thrd_ctrl(void *arg)
+{
+    unsigned cnt;
+    coop_thrd_t inv = {0, 0};
+    (void)arg;
+
+    assert(coop_cancel(inv) == COOP_ERR_INV_ARG);
+    assert(!coop_cancel_pending());
+
+    /* not yet started thread is terminated without being started */
+    assert(coop_cancel(h_new) == COOP_SUCCESS);
+
+    /* let the threads start */
+    coop_yield();
+    CHECK_INVARIANTS();
+    assert(run_cnt == 1);
+
+    assert(coop_cancel(h_run) == COOP_SUCCESS);
+    assert(coop_cancel(h_run) == COOP_SUCCESS);
+    assert(coop_cancel(h_idle) == COOP_SUCCESS);
+    assert(coop_cancel(h_wait) == COOP_SUCCESS);
+    CHECK_INVARIANTS();
+
+    coop_yield();
+    CHECK_INVARIANTS();
+
+    /* waiter returned from the wait and got unwound at the next yield */
+    assert(wait_ret == COOP_ERR_CANCELED);
+    assert(wait_pend);
+    assert(!wait_done);
+
+    /* canceled threads don't return from their cancellation points */
+    cnt = run_cnt;
+    coop_yield();
+    assert(run_cnt == cnt);
+    assert(!idle_done);
+    assert(!new_started);
+
+    /* no idle thread remains accounted; the system idles on ctrl only */
+    coop_idle(10);
+    assert(coop_tick_cb() == 10);
+    CHECK_INVARIANTS();
+
+    /* handles of terminated threads are invalid */
+    assert(coop_cancel(h_run) == COOP_ERR_INV_ARG);
+    assert(coop_cancel(h_new) == COOP_ERR_INV_ARG);
+}
+
+static void thrd_evg(void *arg)
+{
+    (void)arg;
+
+    /* cancel-pending thread gets unwound on the event group wait entry */
+    assert(coop_cancel(coop_thread_self()) == COOP_SUCCESS);
+    coop_evgroup_wait(&evg, 1, false, false, 0, NULL);
+    assert(false);
+}
+
+static void thrd_reuse(void *arg)
+{
+    (void)arg;
+    reuse_ret = coop_wait(SEM_ID, 100);
+}
+
+static void thrd_ctrl_reuse(void *arg)
+{
+    (void)arg;
+
+    /* let the event group waiter start and get canceled */
+    coop_yield();
+    CHECK_INVARIANTS();
+
+    /* the canceled thread's slot is reused by a plain waiter */
+    assert(coop_sched_thread_h(
+        thrd_reuse, "reuse", NULL, NULL, &h_reuse) == COOP_SUCCESS);
+    assert(h_reuse.idx == 1);
+
+    coop_yield();
+    coop_notify(SEM_ID);
+    coop_yield();
+
+    assert(reuse_ret == COOP_SUCCESS);
+    assert(coop_tick_cb() < 100);
+    CHECK_INVARIANTS();
+}
+
+int main(void)
+{
+    coop_sim_reset(0);
+
+    coop_sched_thread_ex(thrd_ctrl, "ctrl", NULL, NULL);
+    coop_sched_thread_h(thrd_run, "run", NULL, NULL, &h_run);
+    coop_sched_thread_h(thrd_idle, "idle", NULL, NULL, &h_idle);
+    coop_sched_thread_h(thrd_wait, "wait", NULL, NULL, &h_wait);
+    coop_sched_thread_h(thrd_new, "new", NULL, NULL, &h_new);
+    coop_sched_service();
+
+    CHECK_INVARIANTS();
+
+    coop_sched_thread_ex(thrd_ctrl_reuse, "ctrl", NULL, NULL);
+    coop_sched_thread_ex(thrd_evg, "evg", NULL, NULL);
+    coop_sched_service();
+
+    CHECK_INVARIANTS();
+    return 0;
+}
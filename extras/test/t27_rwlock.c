@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include "coop_threads.h"
+
+#define SEM_ID  1
+
+static coop_rwlock_t lock;
+
+static unsigned readers, max_readers, rd_done;
+static bool wr_done, wr_timeout;
+static coop_tick_t rd_tick;
+
+static void thrd_reader(void *arg)
+{
+    (void)arg;
+    assert(coop_rwlock_rdlock(&lock, 0) == COOP_SUCCESS);
+
+    /* the writer has already left */
+    assert(wr_done);
+    rd_tick = coop_tick_cb();
+
+    readers++;
+    if (readers > max_readers) max_readers = readers;
+    coop_yield();
+    readers--;
+
+    coop_rwlock_rdunlock(&lock);
+    rd_done++;
+}
+
+static void thrd_writer(void *arg)
+{
+    (void)arg;
+    assert(coop_rwlock_wrlock(&lock, 0) == COOP_SUCCESS);
+    assert(!readers);
+
+    /* readers don't enter while the writer yields */
+    coop_yield();
+    coop_yield();
+    assert(!readers);
+
+    wr_done = true;
+    coop_rwlock_wrunlock(&lock);
+}
+
+static void thrd_writer_tmo(void *arg)
+{
+    (void)arg;
+    assert(coop_rwlock_wrlock(&lock, 10) == COOP_ERR_TIMEOUT);
+    wr_timeout = true;
+}
+
+static void thrd_ctrl(void *arg)
+{
+    (void)arg;
+
+    /* uncontended acquisition doesn't yield */
+    assert(coop_rwlock_rdlock(&lock, 0) == COOP_SUCCESS);
+    assert(coop_rwlock_rdlock(&lock, 0) == COOP_SUCCESS);
+    coop_rwlock_rdunlock(&lock);
+
+    /* writer waits for the reader; new readers wait for the writer */
+    coop_sched_thread(thrd_writer, "writer", 0, NULL);
+    coop_sched_thread(thrd_reader, "reader", 0, NULL);
+    coop_sched_thread(thrd_reader, "reader", 0, NULL);
+    coop_yield();
+    assert(!wr_done && !rd_done);
+
+    /* the last reader leaves; parked readers are released in one pass */
+    coop_rwlock_rdunlock(&lock);
+    while (rd_done < 2) coop_yield();
+    assert(max_readers == 2);
+
+    /* writer locked out by a reader times out */
+    assert(coop_rwlock_rdlock(&lock, 0) == COOP_SUCCESS);
+    wr_done = false;
+    coop_sched_thread(thrd_writer_tmo, "writer_tmo", 0, NULL);
+    coop_yield();
+
+    /* the reader waits for the waiting writer and enters after its timeout */
+    wr_done = true;
+    coop_sched_thread(thrd_reader, "reader", 0, NULL);
+    coop_idle(50);
+    assert(wr_timeout);
+    assert(rd_done == 3);
+    assert(rd_tick == 10);
+
+    coop_rwlock_rdunlock(&lock);
+    assert(coop_rwlock_wrlock(&lock, 0) == COOP_SUCCESS);
+    assert(coop_rwlock_rdlock(&lock, 10) == COOP_ERR_TIMEOUT);
+    coop_rwlock_wrunlock(&lock);
+}
+
+int main(void)
+{
+    coop_sim_reset(0);
+    coop_rwlock_init(&lock, SEM_ID);
+
+    coop_sched_thread(thrd_ctrl, "ctrl", 0, NULL);
+    coop_sched_service();
+
+    return 0;
+}
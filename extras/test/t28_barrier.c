@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include "coop_threads.h"
+
+#define SEM_BAR     1
+#define SEM_LATCH   2
+#define SEM_TMO     3
+
+#define PARTIES 3
+#define PHASES  4
+
+static coop_barrier_t bar;
+static coop_latch_t latch;
+
+static unsigned phase_cnt[PHASES];
+
+static void thrd_party(void *arg)
+{
+    unsigned n = (unsigned)(size_t)arg;
+
+    for (unsigned p = 0; p < PHASES; p++)
+    {
+        /* parties arrive in different order */
+        for (unsigned i = 0; i < n; i++) coop_yield();
+        phase_cnt[p]++;
+
+        assert(coop_barrier_wait(&bar, 0) == COOP_SUCCESS);
+
+        /* all the parties completed the phase */
+        assert(phase_cnt[p] == PARTIES);
+        if (p + 1 < PHASES) assert(phase_cnt[p + 1] < PARTIES);
+    }
+    coop_latch_count_down(&latch);
+}
+
+static void thrd_ctrl(void *arg)
+{
+    coop_barrier_t bar_tmo;
+    (void)arg;
+
+    assert(coop_barrier_init(&bar_tmo, SEM_TMO, 0) == COOP_ERR_INV_ARG);
+
+    /* released when all the parties finish */
+    assert(coop_latch_wait(&latch, 0) == COOP_SUCCESS);
+    for (unsigned p = 0; p < PHASES; p++) assert(phase_cnt[p] == PARTIES);
+    assert(bar.arrived == 0 && bar.gen == PHASES);
+
+    /* released latch doesn't block */
+    coop_latch_count_down(&latch);
+    assert(coop_latch_wait(&latch, 10) == COOP_SUCCESS);
+    assert(coop_tick_cb() == 0);
+
+    /* timed out party is withdrawn from the barrier */
+    assert(coop_barrier_init(&bar_tmo, SEM_TMO, 2) == COOP_SUCCESS);
+    assert(coop_barrier_wait(&bar_tmo, 10) == COOP_ERR_TIMEOUT);
+    assert(coop_tick_cb() == 10);
+    assert(bar_tmo.arrived == 0 && bar_tmo.gen == 0);
+
+    assert(coop_latch_init(&latch, SEM_LATCH, 1) == COOP_SUCCESS);
+    assert(coop_latch_wait(&latch, 10) == COOP_ERR_TIMEOUT);
+    assert(coop_tick_cb() == 20);
+}
+
+int main(void)
+{
+    coop_sim_reset(0);
+    coop_barrier_init(&bar, SEM_BAR, PARTIES);
+    coop_latch_init(&latch, SEM_LATCH, PARTIES);
+
+    coop_sched_thread(thrd_ctrl, "ctrl", 0, NULL);
+    for (size_t i = 0; i < PARTIES; i++) {
+        coop_sched_thread(thrd_party, "party", 0, (void*)i);
+    }
+    coop_sched_service();
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include "coop_threads.h"
+
+#define SEM_ID  1
+
+static coop_buf_t *wait_buf;
+static coop_error_t tmo_ret = COOP_SUCCESS;
+
+static void thrd_alloc(void *arg)
+{
+    (void)arg;
+    assert(coop_buf_alloc(&wait_buf, 0) == COOP_SUCCESS);
+    assert(wait_buf->refs == 1 && wait_buf->len == 0);
+}
+
+static void thrd_alloc_tmo(void *arg)
+{
+    coop_buf_t *buf;
+    (void)arg;
+    tmo_ret = coop_buf_alloc(&buf, 10);
+}
+
+static void thrd_ctrl(void *arg)
+{
+    coop_buf_t *b1, *b2;
+    (void)arg;
+
+    assert(coop_bufpool_free_n() == CONFIG_BUFPOOL_BUFS);
+    assert(coop_buf_alloc(NULL, 0) == COOP_ERR_INV_ARG);
+
+    assert((b1 = coop_buf_try_alloc()) != NULL);
+    assert((b2 = coop_buf_try_alloc()) != NULL);
+    assert(b1 != b2);
+    assert(!coop_buf_try_alloc());
+    assert(coop_bufpool_free_n() == 0);
+
+    /* shared buffer is freed with its last reference dropped */
+    b1->data[0] = 0xa5;
+    b1->len = 1;
+    coop_buf_ref(b1);
+    coop_buf_unref(b1);
+    assert(coop_bufpool_free_n() == 0);
+
+    /* allocators wait on the exhausted pool */
+    coop_sched_thread(thrd_alloc, "alloc", 0, NULL);
+    coop_sched_thread(thrd_alloc_tmo, "alloc_tmo", 0, NULL);
+    coop_yield();
+    assert(!wait_buf);
+
+    /* freed buffer goes to exactly one waiter */
+    coop_buf_unref(b1);
+    coop_yield();
+    assert(wait_buf == b1);
+    assert(tmo_ret == COOP_SUCCESS);
+    assert(coop_bufpool_free_n() == 0);
+
+    /* the second waiter times out */
+    coop_idle(20);
+    assert(tmo_ret == COOP_ERR_TIMEOUT);
+
+    coop_buf_unref(wait_buf);
+    coop_buf_unref(b2);
+    assert(coop_bufpool_free_n() == CONFIG_BUFPOOL_BUFS);
+}
+
+int main(void)
+{
+    coop_sim_reset(0);
+    coop_bufpool_init(SEM_ID);
+
+    coop_sched_thread(thrd_ctrl, "ctrl", 0, NULL);
+    coop_sched_service();
+
+    return 0;
+}
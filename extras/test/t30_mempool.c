@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+#include "coop_threads.h"
+
+#define SEM_ID  1
+
+#define BLK_SZ  20
+#define BLK_N   3
+
+static COOP_MEMPOOL_MEM(mem, BLK_SZ, BLK_N);
+static coop_mempool_t pool;
+
+static void *leak_blk;
+static const char *leak_owner;
+static unsigned leaks_n;
+
+static void *wait_blk;
+static coop_error_t tmo_ret = COOP_SUCCESS;
+
+static void leak_cb(void *blk, const char *owner, void *arg)
+{
+    (void)arg;
+    leak_blk = blk;
+    leak_owner = owner;
+}
+
+static void on_terminate(unsigned thrd)
+{
+    (void)thrd;
+    leaks_n += coop_mempool_owned(&pool, true, leak_cb, NULL);
+}
+
+static const coop_hooks_t hooks = { .terminate = on_terminate };
+
+static void thrd_leak(void *arg)
+{
+    (void)arg;
+    assert(coop_mempool_try_alloc(&pool) != NULL);
+}
+
+static void thrd_alloc(void *arg)
+{
+    (void)arg;
+    assert(coop_mempool_alloc(&pool, &wait_blk, 0) == COOP_SUCCESS);
+}
+
+static void thrd_alloc_tmo(void *arg)
+{
+    void *blk;
+    (void)arg;
+    tmo_ret = coop_mempool_alloc(&pool, &blk, 10);
+}
+
+static void thrd_ctrl(void *arg)
+{
+    void *blks[BLK_N];
+    (void)arg;
+
+    assert(coop_mempool_free_n(&pool) == BLK_N);
+
+    /* blocks are distinct, aligned and don't overlap */
+    for (unsigned i = 0; i < BLK_N; i++) {
+        assert((blks[i] = coop_mempool_try_alloc(&pool)) != NULL);
+        assert(((size_t)blks[i] % sizeof(coop_mempool_align_t)) == 0);
+        memset(blks[i], i, BLK_SZ);
+    }
+    assert(!coop_mempool_try_alloc(&pool));
+    for (unsigned i = 0; i < BLK_N; i++) {
+        assert(((unsigned char*)blks[i])[BLK_SZ - 1] == i);
+    }
+    assert(coop_mempool_owned(&pool, true, NULL, NULL) == BLK_N);
+
+    /* allocators wait on the exhausted pool */
+    coop_sched_thread(thrd_alloc, "alloc", 0, NULL);
+    coop_sched_thread(thrd_alloc_tmo, "alloc_tmo", 0, NULL);
+    coop_yield();
+    assert(!wait_blk);
+
+    /* freed block goes to exactly one waiter; the other times out */
+    coop_mempool_free(&pool, blks[1]);
+    coop_yield();
+    assert(wait_blk == blks[1]);
+    coop_idle(20);
+    assert(tmo_ret == COOP_ERR_TIMEOUT);
+
+    /* the waiter exited holding the block */
+    assert(leaks_n == 1 && leak_blk == blks[1]);
+    assert(!strcmp(leak_owner, "alloc"));
+    coop_mempool_free(&pool, blks[1]);
+
+    /* block not freed by an exiting thread is reported with its owner */
+    coop_sched_thread(thrd_leak, "leak", 0, NULL);
+    coop_yield();
+    assert(leaks_n == 2);
+    assert(leak_blk == blks[1]);
+    assert(!strcmp(leak_owner, "leak"));
+    assert(coop_mempool_owned(&pool, false, NULL, NULL) == BLK_N);
+    assert(coop_mempool_owned(&pool, true, NULL, NULL) == BLK_N - 1);
+
+    coop_mempool_free(&pool, blks[0]);
+    coop_mempool_free(&pool, blks[2]);
+    coop_mempool_free(&pool, leak_blk);
+    assert(coop_mempool_free_n(&pool) == BLK_N);
+    assert(!coop_mempool_owned(&pool, false, NULL, NULL));
+}
+
+int main(void)
+{
+    coop_sim_reset(0);
+
+    assert(coop_mempool_init(&pool, mem, sizeof(mem), BLK_SZ, SEM_ID) ==
+        COOP_SUCCESS);
+    assert(coop_mempool_init(&pool, (char*)mem + 1, sizeof(mem) - 1, BLK_SZ,
+        SEM_ID) == COOP_ERR_INV_ARG);
+    assert(coop_mempool_init(&pool, mem, sizeof(mem), sizeof(mem), SEM_ID) ==
+        COOP_ERR_INV_ARG);
+    assert(coop_mempool_init(&pool, mem, sizeof(mem), BLK_SZ, SEM_ID) ==
+        COOP_SUCCESS);
+    coop_set_hooks(&hooks);
+
+    coop_sched_thread(thrd_ctrl, "ctrl", 0, NULL);
+    coop_sched_service();
+
+    /* no current thread; block allocated with no owner */
+    assert(!coop_thread_self().gen);
+    assert((leak_blk = coop_mempool_try_alloc(&pool)) != NULL);
+    leak_owner = "none";
+    assert(coop_mempool_owned(&pool, false, leak_cb, NULL) == 1);
+    assert(!leak_owner);
+    assert(!coop_mempool_owned(&pool, true, NULL, NULL));
+    coop_mempool_free(&pool, leak_blk);
+
+    return 0;
+}
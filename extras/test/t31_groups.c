@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include "coop_threads.h"
+
+#define RUN_TICKS   1000
+
+static coop_group_t grp_a, grp_b, grp_b1, grp_b2, grp_c;
+
+static unsigned long dflt_ticks;
+static unsigned idle_n;
+
+/* busy thread consuming 1 tick per time-slice */
+static void thrd_busy(void *arg)
+{
+    while (coop_tick_cb() < RUN_TICKS) {
+        coop_sim_advance(1);
+        if (arg) (*(unsigned long*)arg)++;
+        coop_yield();
+    }
+}
+
+/* under-budget thread being mostly idle */
+static void thrd_idle(void *arg)
+{
+    coop_tick_t start = coop_tick_cb();
+
+    (void)arg;
+    for (idle_n = 0; idle_n < 10; idle_n++) {
+        /* woken-up on time despite busy threads of other groups */
+        assert(coop_tick_cb() == start + idle_n * 10);
+        coop_idle(10);
+    }
+}
+
+/* check the ticks ratio matches the expected one with 5% tolerance */
+static void check_share(coop_tick_t ticks, coop_tick_t total, unsigned share)
+{
+    assert(ticks * 100 >= total * share * 95 / 100);
+    assert(ticks * 100 <= total * share * 105 / 100);
+}
+
+int main(void)
+{
+    coop_thrd_attr_t attr = {0};
+
+    coop_sim_reset(0);
+
+    assert(coop_group_init(&grp_a, "A", 0, NULL) == COOP_ERR_INV_ARG);
+
+    /* A:B:default = 3:1:1; B1:B2 = 1:1 */
+    coop_group_init(&grp_a, "A", 3, NULL);
+    coop_group_init(&grp_b, "B", 1, NULL);
+    coop_group_init(&grp_b1, "B1", 1, &grp_b);
+    coop_group_init(&grp_b2, "B2", 1, &grp_b);
+
+    /* double initialization is rejected */
+    assert(coop_group_init(&grp_b1, "B1", 1, &grp_b) == COOP_ERR_INV_ARG);
+
+    /* thread counts don't impact groups shares */
+    attr.group = &grp_a;
+    coop_sched_thread_ex(thrd_busy, "a", &attr, NULL);
+
+    attr.group = &grp_b1;
+    for (int i = 0; i < 3; i++) {
+        coop_sched_thread_ex(thrd_busy, "b1", &attr, NULL);
+    }
+    attr.group = &grp_b2;
+    coop_sched_thread_ex(thrd_busy, "b2", &attr, NULL);
+
+    coop_sched_thread(thrd_busy, "dflt", 0, &dflt_ticks);
+    coop_sched_thread(thrd_busy, "dflt", 0, &dflt_ticks);
+
+    coop_sched_service();
+
+    check_share(coop_group_run_ticks(&grp_a), RUN_TICKS, 60);
+    check_share(coop_group_run_ticks(&grp_b), RUN_TICKS, 20);
+    check_share(dflt_ticks, RUN_TICKS, 20);
+    check_share(coop_group_run_ticks(&grp_b1), RUN_TICKS, 10);
+    check_share(coop_group_run_ticks(&grp_b2), RUN_TICKS, 10);
+    assert(coop_group_run_ticks(&grp_b) ==
+        coop_group_run_ticks(&grp_b1) + coop_group_run_ticks(&grp_b2));
+
+    /* idle thread of the most under-budget group; busy default ones */
+    coop_group_init(&grp_c, "C", 100, NULL);
+    attr.group = &grp_c;
+    coop_sched_thread_ex(thrd_idle, "c", &attr, NULL);
+    coop_sched_thread(thrd_busy, "dflt", 0, NULL);
+
+    coop_sim_reset(0);
+    coop_sched_service();
+
+    assert(idle_n == 10);
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <signal.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include "coop_threads.h"
+
+static unsigned long_n;
+static const char *long_name;
+static coop_tick_t long_slice;
+
+static volatile sig_atomic_t wdog_n;
+static const char *volatile wdog_name;
+
+static void on_long_slice(const char *name, coop_tick_t slice)
+{
+    long_n++;
+    long_name = name;
+    long_slice = slice;
+}
+
+static void on_alrm(int sig)
+{
+    (void)sig;
+}
+
+static void on_wdog(unsigned thrd, const char *name)
+{
+    (void)thrd;
+    wdog_n++;
+    wdog_name = name;
+}
+
+/* consume virtual clock ticks within a single time-slice */
+static void thrd_ticks(void *arg)
+{
+    coop_sim_advance((coop_tick_t)(size_t)arg);
+    coop_yield();
+}
+
+/* busy-loop for 100ms of real time without yielding */
+static void thrd_spin(void *arg)
+{
+    struct timespec start, now;
+    (void)arg;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - start.tv_sec) * 1000 +
+        (now.tv_nsec - start.tv_nsec) / 1000000 < 100);
+}
+
+int main(void)
+{
+    static const coop_hooks_t hooks = {0};
+    const coop_hooks_t *prev_hooks;
+    void (*prev_alrm)(int);
+
+    coop_sim_reset(0);
+
+    /* time-slices above the threshold are reported */
+    assert(coop_set_long_slice_cb(on_long_slice, 10) == NULL);
+    coop_sched_thread(thrd_ticks, "short", 0, (void*)10);
+    coop_sched_thread(thrd_ticks, "long", 0, (void*)20);
+    coop_sched_service();
+
+    assert(long_n == 1);
+    assert(!strcmp(long_name, "long"));
+    assert(long_slice == 20);
+    assert(coop_set_long_slice_cb(NULL, 0) == on_long_slice);
+
+    /* SIGALRM handled by the application is not taken over */
+    prev_alrm = signal(SIGALRM, on_alrm);
+    assert(coop_wdog_start(20000, on_wdog) == COOP_ERR_LIMIT);
+    assert(signal(SIGALRM, prev_alrm) == on_alrm);
+
+    /* thread never yielding within the timeout is caught by the watchdog */
+    assert(coop_wdog_start(0, on_wdog) == COOP_ERR_INV_ARG);
+    assert(coop_wdog_start(20000, on_wdog) == COOP_SUCCESS);
+    assert(coop_wdog_start(20000, on_wdog) == COOP_ERR_LIMIT);
+
+    coop_sched_thread(thrd_ticks, "short", 0, (void*)1);
+    coop_sched_thread(thrd_spin, "spin", 0, NULL);
+    coop_sched_service();
+
+    /* hooks chained to the watchdog ones are to be uninstalled first */
+    prev_hooks = coop_set_hooks(&hooks);
+    assert(coop_wdog_stop() == COOP_ERR_LIMIT);
+    assert(coop_set_hooks(prev_hooks) == &hooks);
+    assert(coop_wdog_stop() == COOP_SUCCESS);
+    assert(coop_set_hooks(NULL) == NULL);
+
+    assert(wdog_n == 1);
+    assert(!strcmp(wdog_name, "spin"));
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include "coop_threads.h"
+
+#define RUN_TICKS   200
+
+static bool compute_done = false;
+static coop_tick_t late_run = 0;
+
+/* compute thread yielding each tick; each yield releases its next job */
+static void thrd_compute(void *arg)
+{
+    (void)arg;
+
+    while (coop_tick_cb() < RUN_TICKS) {
+        coop_sim_advance(1);
+        coop_yield();
+    }
+    assert(!coop_thread_dl_misses());
+    compute_done = true;
+}
+
+/* thread with a later deadline must not be starved by the compute thread */
+static void thrd_late_dl(void *arg)
+{
+    (void)arg;
+
+    late_run = coop_tick_cb();
+    assert(!compute_done);
+}
+
+int main(void)
+{
+    coop_thrd_attr_t attr = {0};
+
+    coop_sim_reset(0);
+
+    attr.deadline = 10;
+    coop_sched_thread_ex(thrd_compute, "compute", &attr, NULL);
+
+    attr.deadline = 50;
+    coop_sched_thread_ex(thrd_late_dl, "late_dl", &attr, NULL);
+
+    coop_sched_service();
+
+    /* run once the compute thread's next job deadline reached 50 */
+    assert(compute_done);
+    assert(late_run >= 40 && late_run <= 50);
+
+    return 0;
+}
@@ -9,31 +9,229 @@
 #if defined(T02) || defined(T03)
 # define CONFIG_OPT_IDLE
 # define CONFIG_IDLE_CB_ALT
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
 #endif
 
 #ifdef T04
 # define CONFIG_OPT_YIELD_AFTER
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
 #endif
 
 #ifdef T05
 # define CONFIG_OPT_WAIT
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
 #endif
 
 #if defined(T06) || defined(T08)
 # define CONFIG_OPT_WAIT
 # define CONFIG_OPT_IDLE
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
 #endif
 
 #ifdef T07
 # define CONFIG_OPT_WAIT
 # define CONFIG_OPT_IDLE
 # define CONFIG_IDLE_CB_ALT
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
 #endif
 
 #ifdef T09
 # define CONFIG_OPT_STACK_WM
 #endif
 
+#ifdef T10
+# undef CONFIG_MAX_THREADS
+# define CONFIG_MAX_THREADS 64
+# define CONFIG_OPT_DYN_POOL
+# define CONFIG_DYN_POOL_CHUNK 4
+#endif
+
+#ifdef T11
+# define CONFIG_OPT_HOLE_REUSE
+# define CONFIG_HOLE_REUSE_MARGIN 0x100U
+#endif
+
+#ifdef T12
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_WORKERS
+# define CONFIG_OPT_CANCEL
+#endif
+
+#ifdef T13
+# define CONFIG_OPT_IDLE
+# define CONFIG_IDLE_CB_ALT
+# define CONFIG_OPT_TIMERS
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T14
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_QUANTUM
+# define CONFIG_DEFAULT_QUANTUM 0
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T15
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_EDF
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T16
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_IDLE
+#endif
+
+#ifdef T17
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_EVGROUPS
+# define CONFIG_OPT_HOOKS
+#endif
+
+#ifdef T18
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_WAIT_DEFER_PREDIC
+# define CONFIG_WAIT_DEFER_QUEUE 2
+#endif
+
+#ifdef T19
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_LOAD_STATS
+# define CONFIG_LOAD_WINDOW_BUCKETS 8
+# define CONFIG_LOAD_BUCKET_TICKS 125
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T20
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_IDLE
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 4
+#endif
+
+#ifdef T21
+# define CONFIG_OPT_STACK_WM
+# define CONFIG_OPT_STACK_PROF
+# define CONFIG_STACK_PROF_ENTRIES 3
+# define CONFIG_STACK_PROF_MARGIN 0x40U
+#endif
+
+#ifdef T22
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_HOOKS
+#endif
+
+#ifdef T23
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_HOOKS
+# define CONFIG_OPT_UNIX_PROF
+# define CONFIG_UNIX_PROF_SAMPLES 4096
+#endif
+
+#ifdef T24
+# define CONFIG_OPT_IDLE
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T25
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_SUSPEND
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T26
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_EVGROUPS
+# define CONFIG_OPT_CANCEL
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T27
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_RWLOCK
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T28
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_BARRIER
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T29
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_BUFPOOL
+# define CONFIG_BUFPOOL_BUFS 2
+# define CONFIG_BUFPOOL_BUF_SZ 0x10U
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T30
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_HOOKS
+# define CONFIG_OPT_MEMPOOL
+# define CONFIG_OPT_MEMPOOL_OWNER
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T31
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_GROUPS
+# define CONFIG_GROUPS_ROUND_TICKS 100
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T32
+# define CONFIG_OPT_HOOKS
+# define CONFIG_OPT_LONG_SLICE
+# define CONFIG_LONG_SLICE_TICKS 50
+# define CONFIG_OPT_UNIX_WDOG
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
+#ifdef T33
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_EDF
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
+
 #ifdef ST01
 # define CONFIG_OPT_IDLE
 #endif
+
+#ifdef ST02
+# define CONFIG_OPT_IDLE
+# define CONFIG_OPT_WAIT
+# define CONFIG_OPT_YIELD_AFTER
+# define CONFIG_OPT_STACK_WM
+# define CONFIG_PLATFORM_SIM
+# define CONFIG_SIM_EVENTS_MAX 1
+#endif
@@ -30,11 +30,80 @@
 /**
  * Maximum number of threads supported by the library.
  * Defined as threads pool size.
+ *
+ * @note If @ref CONFIG_OPT_DYN_POOL is configured, the parameter specifies
+ *     upper limit the dynamically allocated threads pool may grow up to.
  */
 # ifndef CONFIG_MAX_THREADS
 #  define CONFIG_MAX_THREADS 5
 # endif
 
+/**
+ * Boolean parameter to enable dynamic threads pool. Threads contexts are
+ * allocated on the heap in chunks of @ref CONFIG_DYN_POOL_CHUNK size. The pool
+ * grows on demand (up to @ref CONFIG_MAX_THREADS contexts) and shrinks while
+ * the contexts are not used anymore. Unused chunks are released by the
+ * scheduler after terminated threads stacks are unwound and before the system
+ * goes idle (@ref CONFIG_OPT_IDLE), not at the very thread termination.
+ *
+ * @note Intended for platforms with a reliable heap (e.g. Linux) running large
+ *     number of threads. Note the threads stacks are still allocated on the
+ *     main stack, therefore its size needs to be adjusted accordingly.
+ */
+# ifndef CONFIG_OPT_DYN_POOL
+#  define CONFIG_OPT_DYN_POOL 0
+# endif
+
+/**
+ * Number of threads contexts allocated at once by the dynamic threads pool.
+ * Valid only if @ref CONFIG_OPT_DYN_POOL is configured.
+ */
+# ifndef CONFIG_DYN_POOL_CHUNK
+#  define CONFIG_DYN_POOL_CHUNK 32
+# endif
+
+/**
+ * Boolean parameter to enable statically allocated pool of reference counted
+ * buffers: @ref coop_buf_alloc(), @ref coop_buf_unref(). Requires
+ * @ref CONFIG_OPT_WAIT.
+ */
+# ifndef CONFIG_OPT_BUFPOOL
+#  define CONFIG_OPT_BUFPOOL 0
+# endif
+
+/**
+ * Number of buffers in the buffers pool. Valid only if
+ * @ref CONFIG_OPT_BUFPOOL is configured.
+ */
+# ifndef CONFIG_BUFPOOL_BUFS
+#  define CONFIG_BUFPOOL_BUFS 8
+# endif
+
+/**
+ * Size of a single buffer in the buffers pool. Valid only if
+ * @ref CONFIG_OPT_BUFPOOL is configured.
+ */
+# ifndef CONFIG_BUFPOOL_BUF_SZ
+#  define CONFIG_BUFPOOL_BUF_SZ 0x100U
+# endif
+
+/**
+ * Boolean parameter to enable fixed-size blocks memory pools:
+ * @ref coop_mempool_init(), @ref coop_mempool_alloc(). Requires
+ * @ref CONFIG_OPT_WAIT.
+ */
+# ifndef CONFIG_OPT_MEMPOOL
+#  define CONFIG_OPT_MEMPOOL 0
+# endif
+
+/**
+ * Boolean parameter to enable tracking of memory pool blocks owner threads
+ * (@ref coop_mempool_owned()). Requires @ref CONFIG_OPT_MEMPOOL.
+ */
+# ifndef CONFIG_OPT_MEMPOOL_OWNER
+#  define CONFIG_OPT_MEMPOOL_OWNER 0
+# endif
+
 /**
  * Boolean parameter to enable @ref coop_idle().
  */
@@ -42,6 +111,14 @@
 #  define CONFIG_OPT_IDLE 1
 # endif
 
+/**
+ * Boolean parameter to enable timers (@ref coop_timer_start()), whose
+ * callbacks are run directly by the scheduler. Requires @ref CONFIG_OPT_IDLE.
+ */
+# ifndef CONFIG_OPT_TIMERS
+#  define CONFIG_OPT_TIMERS 0
+# endif
+
 /**
  * Boolean parameter to enable @ref coop_yield_after().
  */
@@ -49,6 +126,90 @@
 #  define CONFIG_OPT_YIELD_AFTER 1
 # endif
 
+/**
+ * Boolean parameter to enable per-thread time-slice quantum enforced via
+ * @ref coop_yield_check().
+ */
+# ifndef CONFIG_OPT_QUANTUM
+#  define CONFIG_OPT_QUANTUM 0
+# endif
+
+/**
+ * Default thread time-slice quantum (in ticks). 0 means no quantum is applied.
+ * Valid only if @ref CONFIG_OPT_QUANTUM is configured.
+ */
+# ifndef CONFIG_DEFAULT_QUANTUM
+#  define CONFIG_DEFAULT_QUANTUM 10
+# endif
+
+/**
+ * Boolean parameter to enable long time-slices detector reporting threads
+ * running too long without yielding (see @ref coop_set_long_slice_cb()).
+ */
+# ifndef CONFIG_OPT_LONG_SLICE
+#  define CONFIG_OPT_LONG_SLICE 0
+# endif
+
+/**
+ * Default long time-slice threshold (in ticks).
+ * Valid only if @ref CONFIG_OPT_LONG_SLICE is configured.
+ */
+# ifndef CONFIG_LONG_SLICE_TICKS
+#  define CONFIG_LONG_SLICE_TICKS 50
+# endif
+
+/**
+ * Boolean parameter to enable system idle accounting and CPU load metrics:
+ * @ref coop_load_stats(), @ref coop_cpu_load().
+ *
+ * @note The feature requires @ref CONFIG_OPT_IDLE.
+ */
+# ifndef CONFIG_OPT_LOAD_STATS
+#  define CONFIG_OPT_LOAD_STATS 0
+# endif
+
+/**
+ * Number of buckets constituting CPU load sliding-window.
+ * Valid only if @ref CONFIG_OPT_LOAD_STATS is configured.
+ */
+# ifndef CONFIG_LOAD_WINDOW_BUCKETS
+#  define CONFIG_LOAD_WINDOW_BUCKETS 8
+# endif
+
+/**
+ * CPU load sliding-window bucket span (in ticks).
+ * Valid only if @ref CONFIG_OPT_LOAD_STATS is configured.
+ */
+# ifndef CONFIG_LOAD_BUCKET_TICKS
+#  define CONFIG_LOAD_BUCKET_TICKS 125
+# endif
+
+/**
+ * Boolean parameter to enable earliest deadline first (EDF) scheduling policy
+ * for threads with deadlines (see @ref coop_set_deadline()).
+ *
+ * @note The feature requires @ref CONFIG_OPT_IDLE.
+ */
+# ifndef CONFIG_OPT_EDF
+#  define CONFIG_OPT_EDF 0
+# endif
+
+/**
+ * Boolean parameter to enable hierarchical threads groups with CPU shares
+ * (see @ref coop_group_init()).
+ */
+# ifndef CONFIG_OPT_GROUPS
+#  define CONFIG_OPT_GROUPS 0
+# endif
+
+/**
+ * Threads groups accounting round (in ticks). Groups run ticks are reset at
+ * the round end. Valid only if @ref CONFIG_OPT_GROUPS is configured.
+ */
+# ifndef CONFIG_GROUPS_ROUND_TICKS
+#  define CONFIG_GROUPS_ROUND_TICKS 100
+# endif
+
 /**
  * Boolean parameter to enable @ref coop_wait(), @ref coop_notify().
  */
@@ -56,6 +217,80 @@
 #  define CONFIG_OPT_WAIT 1
 # endif
 
+/**
+ * Boolean parameter to defer processing of notifications from
+ * @ref coop_notify() to the scheduler. The notifying routine only queues the
+ * notification in O(1) time (e.g. in ISR); waiting-predicates are evaluated by
+ * the scheduler, once per distinct predicate. Requires @ref CONFIG_OPT_WAIT.
+ */
+# ifndef CONFIG_OPT_WAIT_DEFER_PREDIC
+#  define CONFIG_OPT_WAIT_DEFER_PREDIC 0
+# endif
+
+/**
+ * Size of the deferred notifications queue. Single-notifications on the same
+ * semaphore id sent in a row occupy one queue entry. If the queue is full, the
+ * notification is not queued but the queue overflow is marked instead. On the
+ * overflow the scheduler wakes-up all threads waiting before the overflow
+ * (as if notified-all on their semaphore ids) whose waiting-predicates are
+ * satisfied. Valid only if @ref CONFIG_OPT_WAIT_DEFER_PREDIC is configured.
+ */
+# ifndef CONFIG_WAIT_DEFER_QUEUE
+#  define CONFIG_WAIT_DEFER_QUEUE 8
+# endif
+
+/**
+ * Boolean parameter to enable event groups: @ref coop_evgroup_wait(),
+ * @ref coop_evgroup_set(). Requires @ref CONFIG_OPT_WAIT.
+ */
+# ifndef CONFIG_OPT_EVGROUPS
+#  define CONFIG_OPT_EVGROUPS 0
+# endif
+
+/**
+ * Boolean parameter to enable worker threads pool: @ref coop_workers_init(),
+ * @ref coop_submit(). Requires @ref CONFIG_OPT_WAIT.
+ */
+# ifndef CONFIG_OPT_WORKERS
+#  define CONFIG_OPT_WORKERS 0
+# endif
+
+/**
+ * Boolean parameter to enable reader-writer locks: @ref coop_rwlock_init(),
+ * @ref coop_rwlock_rdlock(), @ref coop_rwlock_wrlock(). Requires
+ * @ref CONFIG_OPT_WAIT.
+ */
+# ifndef CONFIG_OPT_RWLOCK
+#  define CONFIG_OPT_RWLOCK 0
+# endif
+
+/**
+ * Boolean parameter to enable barriers and countdown latches:
+ * @ref coop_barrier_wait(), @ref coop_latch_wait(). Requires
+ * @ref CONFIG_OPT_WAIT.
+ */
+# ifndef CONFIG_OPT_BARRIER
+#  define CONFIG_OPT_BARRIER 0
+# endif
+
+/**
+ * Boolean parameter to enable suspending and resuming threads by their handles
+ * (@ref coop_suspend(), @ref coop_resume()).
+ */
+# ifndef CONFIG_OPT_SUSPEND
+#  define CONFIG_OPT_SUSPEND 0
+# endif
+
+/**
+ * Boolean parameter to enable cooperative threads cancellation
+ * (@ref coop_cancel()).
+ *
+ * @note The feature is not supported by @ref CONFIG_NOEXIT_STATIC_THREADS.
+ */
+# ifndef CONFIG_OPT_CANCEL
+#  define CONFIG_OPT_CANCEL 0
+# endif
+
 /**
  * Boolean parameter to enable @ref coop_stack_wm().
  */
@@ -63,6 +298,43 @@
 #  define CONFIG_OPT_STACK_WM 0
 # endif
 
+/**
+ * Boolean parameter to enable stack-size profiling mode. Stack usage
+ * water-marks of threads are recorded (at threads termination or on demand
+ * by @ref coop_stack_prof_sample()) and may be dumped as a list of
+ * recommended threads stack sizes by @ref coop_stack_prof_dump().
+ *
+ * @note The feature requires @ref CONFIG_OPT_STACK_WM.
+ */
+# ifndef CONFIG_OPT_STACK_PROF
+#  define CONFIG_OPT_STACK_PROF 0
+# endif
+
+/**
+ * Maximum number of distinct threads (identified by their names or routines)
+ * recorded by the stack-size profiler.
+ * Valid only if @ref CONFIG_OPT_STACK_PROF is configured.
+ */
+# ifndef CONFIG_STACK_PROF_ENTRIES
+#  define CONFIG_STACK_PROF_ENTRIES 16
+# endif
+
+/**
+ * Safety margin (in bytes) added to the recorded stack water-mark while
+ * calculating recommended thread stack size.
+ * Valid only if @ref CONFIG_OPT_STACK_PROF is configured.
+ */
+# ifndef CONFIG_STACK_PROF_MARGIN
+#  define CONFIG_STACK_PROF_MARGIN 0x40U
+# endif
+
+/**
+ * Boolean parameter to enable scheduler event hooks (see @ref coop_set_hooks()).
+ */
+# ifndef CONFIG_OPT_HOOKS
+#  define CONFIG_OPT_HOOKS 0
+# endif
+
 /**
  * If the library is used to create static number of threads at its startup
  * and the threads are not intended to exit, this boolean parameter may be
@@ -79,6 +351,35 @@
 #  define CONFIG_NOEXIT_STATIC_THREADS 0
 # endif
 
+/**
+ * Boolean parameter to enable reusing main stack space occupied by holes
+ * (terminated threads whose stacks still occupy the main stack) for newly
+ * scheduled threads. A new thread is placed in the best-fit hole (the smallest
+ * hole the thread's stack fits in), instead of being started on top of the
+ * main stack. This reduces the main stack growth and the threads pool usage
+ * for dynamically created threads.
+ *
+ * @note Not applicable for @ref CONFIG_NOEXIT_STATIC_THREADS configuration.
+ */
+# ifndef CONFIG_OPT_HOLE_REUSE
+#  define CONFIG_OPT_HOLE_REUSE 0
+# endif
+
+/**
+ * Additional hole space (in bytes) required above the requested thread stack
+ * size, for the thread to be placed in the hole. The space is used by stack
+ * frames created from the thread routine entry up to its first yield to the
+ * scheduler (the thread routine's local variables and the library routines
+ * called to yield), before the thread stack is allocated. Valid only if
+ * @ref CONFIG_OPT_HOLE_REUSE is configured.
+ *
+ * @note Too small margin results in the thread's stack overlapping stack
+ *     frames of threads placed above the hole on the main stack.
+ */
+# ifndef CONFIG_HOLE_REUSE_MARGIN
+#  define CONFIG_HOLE_REUSE_MARGIN 0x100U
+# endif
+
 /**
  * Boolean parameter to control logging debug messages.
  *
@@ -120,7 +421,7 @@
  *
  * @note The boolean parameter is valid only if at least one of the following
  *     features is enabled: @ref CONFIG_OPT_YIELD_AFTER, @ref CONFIG_OPT_IDLE,
- *     @ref CONFIG_OPT_WAIT.
+ *     @ref CONFIG_OPT_WAIT, @ref CONFIG_OPT_QUANTUM.
  */
 # ifndef CONFIG_TICK_CB_ALT
 #  define CONFIG_TICK_CB_ALT 0
@@ -137,6 +438,75 @@
 #  define CONFIG_IDLE_CB_ALT 0
 # endif
 
+/**
+ * Alternative implementation of @ref coop_isr_lock_cb() and
+ * @ref coop_isr_unlock_cb() callbacks. Default implementation depends on the
+ * underlying platform.
+ *
+ * @note The boolean parameter is valid only if at least one of the following
+ *     features is enabled: @ref CONFIG_OPT_WAIT_DEFER_PREDIC,
+ *     @ref CONFIG_OPT_EVGROUPS.
+ */
+# ifndef CONFIG_ISR_LOCK_CB_ALT
+#  define CONFIG_ISR_LOCK_CB_ALT 0
+# endif
+
+/**
+ * Boolean parameter to enable the simulation platform (@c platform/sim.c)
+ * with virtual clock. @ref coop_idle_cb() advances virtual ticks instantly
+ * instead of sleeping and external events may be scripted at virtual times
+ * (see @ref coop_sim_event()). Intended for fast and deterministic tests and
+ * benchmarks.
+ *
+ * @note The parameter implies @ref CONFIG_TICK_CB_ALT and
+ *     @ref CONFIG_IDLE_CB_ALT; the callbacks are provided by the simulation
+ *     platform. If @ref CONFIG_IDLE_CB_ALT is configured explicitly,
+ *     @ref coop_idle_cb() is provided by the user and shall pass the idle
+ *     period to @ref coop_sim_idle() to advance the virtual clock.
+ */
+# ifndef CONFIG_PLATFORM_SIM
+#  define CONFIG_PLATFORM_SIM 0
+# endif
+
+/**
+ * Maximum number of scheduled scripted events of the simulation platform.
+ * Valid only if @ref CONFIG_PLATFORM_SIM is configured.
+ */
+# ifndef CONFIG_SIM_EVENTS_MAX
+#  define CONFIG_SIM_EVENTS_MAX 16
+# endif
+
+/**
+ * Boolean parameter to enable Unix platform sampling profiler
+ * (@c platform/unix_prof.c). CPU time samples taken by @c SIGPROF signal
+ * handler are attributed to the coop threads running at the sampling time
+ * (see @ref coop_prof_start()).
+ *
+ * @note The feature requires @ref CONFIG_OPT_HOOKS.
+ */
+# ifndef CONFIG_OPT_UNIX_PROF
+#  define CONFIG_OPT_UNIX_PROF 0
+# endif
+
+/**
+ * Size of the Unix platform profiler samples buffer. Samples taken while
+ * the buffer is full are dropped.
+ * Valid only if @ref CONFIG_OPT_UNIX_PROF is configured.
+ */
+# ifndef CONFIG_UNIX_PROF_SAMPLES
+#  define CONFIG_UNIX_PROF_SAMPLES 4096
+# endif
+
+/**
+ * Boolean parameter to enable Unix platform watchdog (@ref coop_wdog_start())
+ * catching threads not yielding back to the scheduler.
+ *
+ * @note The feature requires @ref CONFIG_OPT_HOOKS.
+ */
+# ifndef CONFIG_OPT_UNIX_WDOG
+#  define CONFIG_OPT_UNIX_WDOG 0
+# endif
+
 #endif
 
 /*
@@ -146,6 +516,34 @@
 #define __XEXT1(__prm) (1##__prm)
 #define __EXT1(__prm) __XEXT1(__prm)
 
+#ifdef CONFIG_OPT_DYN_POOL
+# if (__EXT1(CONFIG_OPT_DYN_POOL) == 1)
+#  undef CONFIG_OPT_DYN_POOL
+#  define CONFIG_OPT_DYN_POOL 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_BUFPOOL
+# if (__EXT1(CONFIG_OPT_BUFPOOL) == 1)
+#  undef CONFIG_OPT_BUFPOOL
+#  define CONFIG_OPT_BUFPOOL 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_MEMPOOL
+# if (__EXT1(CONFIG_OPT_MEMPOOL) == 1)
+#  undef CONFIG_OPT_MEMPOOL
+#  define CONFIG_OPT_MEMPOOL 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_MEMPOOL_OWNER
+# if (__EXT1(CONFIG_OPT_MEMPOOL_OWNER) == 1)
+#  undef CONFIG_OPT_MEMPOOL_OWNER
+#  define CONFIG_OPT_MEMPOOL_OWNER 1
+# endif
+#endif
+
 #ifdef CONFIG_OPT_IDLE
 # if (__EXT1(CONFIG_OPT_IDLE) == 1)
 #  undef CONFIG_OPT_IDLE
@@ -153,6 +551,13 @@
 # endif
 #endif
 
+#ifdef CONFIG_OPT_TIMERS
+# if (__EXT1(CONFIG_OPT_TIMERS) == 1)
+#  undef CONFIG_OPT_TIMERS
+#  define CONFIG_OPT_TIMERS 1
+# endif
+#endif
+
 #ifdef CONFIG_OPT_YIELD_AFTER
 # if (__EXT1(CONFIG_OPT_YIELD_AFTER) == 1)
 #  undef CONFIG_OPT_YIELD_AFTER
@@ -160,6 +565,41 @@
 # endif
 #endif
 
+#ifdef CONFIG_OPT_QUANTUM
+# if (__EXT1(CONFIG_OPT_QUANTUM) == 1)
+#  undef CONFIG_OPT_QUANTUM
+#  define CONFIG_OPT_QUANTUM 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_LONG_SLICE
+# if (__EXT1(CONFIG_OPT_LONG_SLICE) == 1)
+#  undef CONFIG_OPT_LONG_SLICE
+#  define CONFIG_OPT_LONG_SLICE 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_LOAD_STATS
+# if (__EXT1(CONFIG_OPT_LOAD_STATS) == 1)
+#  undef CONFIG_OPT_LOAD_STATS
+#  define CONFIG_OPT_LOAD_STATS 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_EDF
+# if (__EXT1(CONFIG_OPT_EDF) == 1)
+#  undef CONFIG_OPT_EDF
+#  define CONFIG_OPT_EDF 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_GROUPS
+# if (__EXT1(CONFIG_OPT_GROUPS) == 1)
+#  undef CONFIG_OPT_GROUPS
+#  define CONFIG_OPT_GROUPS 1
+# endif
+#endif
+
 #ifdef CONFIG_OPT_WAIT
 # if (__EXT1(CONFIG_OPT_WAIT) == 1)
 #  undef CONFIG_OPT_WAIT
@@ -167,6 +607,55 @@
 # endif
 #endif
 
+#ifdef CONFIG_OPT_WAIT_DEFER_PREDIC
+# if (__EXT1(CONFIG_OPT_WAIT_DEFER_PREDIC) == 1)
+#  undef CONFIG_OPT_WAIT_DEFER_PREDIC
+#  define CONFIG_OPT_WAIT_DEFER_PREDIC 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_EVGROUPS
+# if (__EXT1(CONFIG_OPT_EVGROUPS) == 1)
+#  undef CONFIG_OPT_EVGROUPS
+#  define CONFIG_OPT_EVGROUPS 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_WORKERS
+# if (__EXT1(CONFIG_OPT_WORKERS) == 1)
+#  undef CONFIG_OPT_WORKERS
+#  define CONFIG_OPT_WORKERS 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_RWLOCK
+# if (__EXT1(CONFIG_OPT_RWLOCK) == 1)
+#  undef CONFIG_OPT_RWLOCK
+#  define CONFIG_OPT_RWLOCK 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_BARRIER
+# if (__EXT1(CONFIG_OPT_BARRIER) == 1)
+#  undef CONFIG_OPT_BARRIER
+#  define CONFIG_OPT_BARRIER 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_SUSPEND
+# if (__EXT1(CONFIG_OPT_SUSPEND) == 1)
+#  undef CONFIG_OPT_SUSPEND
+#  define CONFIG_OPT_SUSPEND 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_CANCEL
+# if (__EXT1(CONFIG_OPT_CANCEL) == 1)
+#  undef CONFIG_OPT_CANCEL
+#  define CONFIG_OPT_CANCEL 1
+# endif
+#endif
+
 #ifdef CONFIG_OPT_STACK_WM
 # if (__EXT1(CONFIG_OPT_STACK_WM) == 1)
 #  undef CONFIG_OPT_STACK_WM
@@ -174,6 +663,20 @@
 # endif
 #endif
 
+#ifdef CONFIG_OPT_STACK_PROF
+# if (__EXT1(CONFIG_OPT_STACK_PROF) == 1)
+#  undef CONFIG_OPT_STACK_PROF
+#  define CONFIG_OPT_STACK_PROF 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_HOOKS
+# if (__EXT1(CONFIG_OPT_HOOKS) == 1)
+#  undef CONFIG_OPT_HOOKS
+#  define CONFIG_OPT_HOOKS 1
+# endif
+#endif
+
 #ifdef CONFIG_NOEXIT_STATIC_THREADS
 # if (__EXT1(CONFIG_NOEXIT_STATIC_THREADS) == 1)
 #  undef CONFIG_NOEXIT_STATIC_THREADS
@@ -181,6 +684,13 @@
 # endif
 #endif
 
+#ifdef CONFIG_OPT_HOLE_REUSE
+# if (__EXT1(CONFIG_OPT_HOLE_REUSE) == 1)
+#  undef CONFIG_OPT_HOLE_REUSE
+#  define CONFIG_OPT_HOLE_REUSE 1
+# endif
+#endif
+
 #ifdef COOP_DEBUG
 # if (__EXT1(COOP_DEBUG) == 1)
 #  undef COOP_DEBUG
@@ -209,6 +719,49 @@
 # endif
 #endif
 
+#ifdef CONFIG_ISR_LOCK_CB_ALT
+# if (__EXT1(CONFIG_ISR_LOCK_CB_ALT) == 1)
+#  undef CONFIG_ISR_LOCK_CB_ALT
+#  define CONFIG_ISR_LOCK_CB_ALT 1
+# endif
+#endif
+
+#ifdef CONFIG_PLATFORM_SIM
+# if (__EXT1(CONFIG_PLATFORM_SIM) == 1)
+#  undef CONFIG_PLATFORM_SIM
+#  define CONFIG_PLATFORM_SIM 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_UNIX_PROF
+# if (__EXT1(CONFIG_OPT_UNIX_PROF) == 1)
+#  undef CONFIG_OPT_UNIX_PROF
+#  define CONFIG_OPT_UNIX_PROF 1
+# endif
+#endif
+
+#ifdef CONFIG_OPT_UNIX_WDOG
+# if (__EXT1(CONFIG_OPT_UNIX_WDOG) == 1)
+#  undef CONFIG_OPT_UNIX_WDOG
+#  define CONFIG_OPT_UNIX_WDOG 1
+# endif
+#endif
+
+#if CONFIG_PLATFORM_SIM
+/* user provided idle callback takes precedence over the simulation one */
+# if CONFIG_IDLE_CB_ALT
+#  define __COOP_SIM_IDLE_CB 0
+# else
+#  define __COOP_SIM_IDLE_CB 1
+# endif
+
+/* clock related callbacks provided by the simulation platform */
+# undef CONFIG_TICK_CB_ALT
+# define CONFIG_TICK_CB_ALT 1
+# undef CONFIG_IDLE_CB_ALT
+# define CONFIG_IDLE_CB_ALT 1
+#endif
+
 #undef __EXT1
 #undef __XEXT1
 
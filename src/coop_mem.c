@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+/*
+ * Memory pools.
+ */
+
+#include "coop_threads.h"
+
+#if CONFIG_OPT_BUFPOOL || CONFIG_OPT_MEMPOOL
+# if !CONFIG_OPT_WAIT
+#  error CONFIG_OPT_BUFPOOL and CONFIG_OPT_MEMPOOL require CONFIG_OPT_WAIT
+# endif
+
+/* block's user space and its header */
+#define _BLK_DATA(_hdr) ((void*)((unsigned char*)(_hdr) + __COOP_MEMPOOL_HDR_SZ))
+#define _BLK_HDR(_blk) ((unsigned char*)(_blk) - __COOP_MEMPOOL_HDR_SZ)
+
+/* next free block link stored in the free block's user space */
+#define _BLK_NEXT(_blk) (*(void**)(_blk))
+
+/**
+ * Initialize fixed-size blocks pool (common for memory and buffers pools).
+ */
+static coop_error_t _pool_init(coop_mempool_t *pool,
+    void *mem, size_t mem_sz, size_t blk_sz, int sem_id)
+{
+    if (!pool || !mem ||
+        ((size_t)mem % sizeof(coop_mempool_align_t)) != 0)
+    {
+        return COOP_ERR_INV_ARG;
+    }
+
+    pool->mem = (unsigned char*)mem;
+    pool->blk_sz = COOP_MEMPOOL_BLK_SZ(blk_sz);
+    pool->blk_n = mem_sz / pool->blk_sz;
+    if (!pool->blk_n) return COOP_ERR_INV_ARG;
+
+    pool->free = NULL;
+    for (unsigned i = pool->blk_n; i > 0; i--) {
+        unsigned char *hdr = pool->mem + (i - 1) * pool->blk_sz;
+# if CONFIG_OPT_MEMPOOL_OWNER
+        ((coop_mempool_owner_t*)hdr)->used = false;
+# endif
+        _BLK_NEXT(_BLK_DATA(hdr)) = pool->free;
+        pool->free = _BLK_DATA(hdr);
+    }
+    pool->free_n = pool->blk_n;
+    pool->wait_n = 0;
+    pool->sem_id = sem_id;
+
+    return COOP_SUCCESS;
+}
+
+/**
+ * Allocate a block from the pool; NULL if the pool is exhausted.
+ */
+static void *_pool_try_alloc(coop_mempool_t *pool)
+{
+    void *blk = pool->free;
+
+    if (blk) {
+        pool->free = _BLK_NEXT(blk);
+        pool->free_n--;
+# if CONFIG_OPT_MEMPOOL_OWNER
+        {
+            coop_mempool_owner_t *owner = (coop_mempool_owner_t*)_BLK_HDR(blk);
+
+            /* no owner if allocated outside of a thread (invalid handle) */
+            owner->thrd = coop_thread_self();
+            owner->name = (owner->thrd.gen ? coop_thread_name() : NULL);
+            owner->used = true;
+        }
+# endif
+    }
+    return blk;
+}
+
+/**
+ * Blocking allocation context.
+ */
+typedef struct
+{
+    coop_mempool_t *pool;
+    void *blk;
+} _pool_alloc_ctx_t;
+
+static bool _pool_try(void *ctx)
+{
+    _pool_alloc_ctx_t *alloc = (_pool_alloc_ctx_t*)ctx;
+
+    alloc->blk = _pool_try_alloc(alloc->pool);
+    return (alloc->blk != NULL);
+}
+
+/**
+ * Allocate a block from the pool; wait for a block to be freed if the pool is
+ * exhausted.
+ */
+static coop_error_t _pool_alloc(coop_mempool_t *pool, void **blk,
+    coop_tick_t timeout)
+{
+    _pool_alloc_ctx_t alloc = { pool, NULL };
+    coop_error_t ret;
+
+    ret = _coop_timed_wait(pool->sem_id, &pool->wait_n, _pool_try, &alloc,
+        timeout);
+    *blk = alloc.blk;
+
+    if (ret != COOP_SUCCESS && pool->free_n > 0 && pool->wait_n > 0) {
+        /* pass the wake-up on if the waiter gave up */
+        coop_notify(pool->sem_id);
+    }
+    return ret;
+}
+
+/**
+ * Return a block to the pool.
+ */
+static void _pool_free(coop_mempool_t *pool, void *blk)
+{
+# if CONFIG_OPT_MEMPOOL_OWNER
+    ((coop_mempool_owner_t*)_BLK_HDR(blk))->used = false;
+# endif
+    _BLK_NEXT(blk) = pool->free;
+    pool->free = blk;
+    pool->free_n++;
+
+    if (pool->wait_n > 0) {
+        /* wake up exactly one waiting allocator */
+        coop_notify(pool->sem_id);
+    }
+}
+#endif /* CONFIG_OPT_BUFPOOL || CONFIG_OPT_MEMPOOL */
+
+#if CONFIG_OPT_BUFPOOL
+/* statically allocated buffers pool and its space */
+static coop_mempool_t bufpool;
+static COOP_MEMPOOL_MEM(bufpool_mem, sizeof(coop_buf_t), CONFIG_BUFPOOL_BUFS);
+
+void coop_bufpool_init(int sem_id)
+{
+    _pool_init(&bufpool, bufpool_mem, sizeof(bufpool_mem), sizeof(coop_buf_t),
+        sem_id);
+}
+
+coop_buf_t *coop_buf_try_alloc(void)
+{
+    coop_buf_t *buf = (coop_buf_t*)_pool_try_alloc(&bufpool);
+
+    if (buf) {
+        buf->refs = 1;
+        buf->len = 0;
+    }
+    return buf;
+}
+
+coop_error_t coop_buf_alloc(coop_buf_t **buf, coop_tick_t timeout)
+{
+    coop_error_t ret;
+
+    if (!buf) return COOP_ERR_INV_ARG;
+
+    ret = _pool_alloc(&bufpool, (void**)buf, timeout);
+    if (ret == COOP_SUCCESS) {
+        (*buf)->refs = 1;
+        (*buf)->len = 0;
+    }
+    return ret;
+}
+
+void coop_buf_ref(coop_buf_t *buf)
+{
+    buf->refs++;
+}
+
+void coop_buf_unref(coop_buf_t *buf)
+{
+    if (--buf->refs > 0) return;
+    _pool_free(&bufpool, buf);
+}
+
+unsigned coop_bufpool_free_n(void)
+{
+    return bufpool.free_n;
+}
+#endif /* CONFIG_OPT_BUFPOOL */
+
+#if CONFIG_OPT_MEMPOOL
+coop_error_t coop_mempool_init(coop_mempool_t *pool,
+    void *mem, size_t mem_sz, size_t blk_sz, int sem_id)
+{
+    return _pool_init(pool, mem, mem_sz, blk_sz, sem_id);
+}
+
+void *coop_mempool_try_alloc(coop_mempool_t *pool)
+{
+    return _pool_try_alloc(pool);
+}
+
+coop_error_t coop_mempool_alloc(coop_mempool_t *pool, void **blk,
+    coop_tick_t timeout)
+{
+    if (!pool || !blk) return COOP_ERR_INV_ARG;
+    return _pool_alloc(pool, blk, timeout);
+}
+
+void coop_mempool_free(coop_mempool_t *pool, void *blk)
+{
+    _pool_free(pool, blk);
+}
+
+unsigned coop_mempool_free_n(const coop_mempool_t *pool)
+{
+    return pool->free_n;
+}
+
+# if CONFIG_OPT_MEMPOOL_OWNER
+unsigned coop_mempool_owned(coop_mempool_t *pool, bool cur,
+    coop_mempool_cb_t cb, void *arg)
+{
+    coop_thrd_t self = coop_thread_self();
+    unsigned n = 0;
+
+    for (unsigned i = 0; i < pool->blk_n; i++)
+    {
+        coop_mempool_owner_t *owner =
+            (coop_mempool_owner_t*)(pool->mem + i * pool->blk_sz);
+
+        if (!owner->used || (cur && (!self.gen ||
+            owner->thrd.idx != self.idx || owner->thrd.gen != self.gen)))
+        {
+            continue;
+        }
+
+        n++;
+        if (cb) cb(_BLK_DATA(owner), owner->name, arg);
+    }
+    return n;
+}
+# endif
+#elif CONFIG_OPT_MEMPOOL_OWNER
+# error CONFIG_OPT_MEMPOOL_OWNER requires CONFIG_OPT_MEMPOOL
+#endif /* CONFIG_OPT_MEMPOOL */
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+/*
+ * Synchronization primitives.
+ */
+
+#include "coop_threads.h"
+
+#if CONFIG_OPT_RWLOCK
+# if !CONFIG_OPT_WAIT
+#  error CONFIG_OPT_RWLOCK requires CONFIG_OPT_WAIT
+# endif
+
+/* semaphore ids used by the reader-writer lock */
+#define _SEM_RD(_lock) ((_lock)->sem_id)
+#define _SEM_WR(_lock) ((_lock)->sem_id + 1)
+
+/* lock may be acquired by a reader; readers don't overtake waiting writers */
+#define _RD_FREE(_lock) (!(_lock)->writer && !(_lock)->wr_wait_n)
+
+/* lock may be acquired by a writer */
+#define _WR_FREE(_lock) (!(_lock)->writer && !(_lock)->readers)
+
+/**
+ * Wake-up the lock waiters after the lock state change.
+ */
+static void _rw_wake(coop_rwlock_t *lock)
+{
+    if (lock->writer) return;
+
+    if (lock->wr_wait_n > 0) {
+        /* writers preference: a single writer is woken-up */
+        if (!lock->readers) coop_notify(_SEM_WR(lock));
+    } else if (lock->rd_wait_n > 0) {
+        /* all parked readers are released in one pass */
+        coop_notify_all(_SEM_RD(lock));
+    }
+}
+
+static bool _rd_free(void *ctx)
+{
+    return _RD_FREE((coop_rwlock_t*)ctx);
+}
+
+static bool _wr_free(void *ctx)
+{
+    return _WR_FREE((coop_rwlock_t*)ctx);
+}
+
+/**
+ * Wait for the lock to become free for a reader (@c wr is @c false) or writer
+ * (@c wr is @c true).
+ */
+static coop_error_t _rw_wait(coop_rwlock_t *lock, bool wr, coop_tick_t timeout)
+{
+    coop_error_t ret = (wr ?
+        _coop_timed_wait(_SEM_WR(lock), &lock->wr_wait_n, _wr_free, lock,
+            timeout) :
+        _coop_timed_wait(_SEM_RD(lock), &lock->rd_wait_n, _rd_free, lock,
+            timeout));
+
+    /* pass the wake-up on if the waiter gave up */
+    if (ret != COOP_SUCCESS) _rw_wake(lock);
+    return ret;
+}
+
+void coop_rwlock_init(coop_rwlock_t *lock, int sem_id)
+{
+    lock->sem_id = sem_id;
+    lock->readers = lock->rd_wait_n = lock->wr_wait_n = 0;
+    lock->writer = false;
+}
+
+coop_error_t coop_rwlock_rdlock(coop_rwlock_t *lock, coop_tick_t timeout)
+{
+    coop_error_t ret = COOP_SUCCESS;
+
+    if (!_RD_FREE(lock)) {
+        coop_dbg_log_cb("Reader %s waits on rwlock %p\n",
+            coop_thread_name(), (void*)lock);
+
+        ret = _rw_wait(lock, false, timeout);
+    }
+    if (ret == COOP_SUCCESS) lock->readers++;
+    return ret;
+}
+
+void coop_rwlock_rdunlock(coop_rwlock_t *lock)
+{
+    lock->readers--;
+    if (!lock->readers) _rw_wake(lock);
+}
+
+coop_error_t coop_rwlock_wrlock(coop_rwlock_t *lock, coop_tick_t timeout)
+{
+    coop_error_t ret = COOP_SUCCESS;
+
+    if (!_WR_FREE(lock)) {
+        coop_dbg_log_cb("Writer %s waits on rwlock %p\n",
+            coop_thread_name(), (void*)lock);
+
+        ret = _rw_wait(lock, true, timeout);
+    }
+    if (ret == COOP_SUCCESS) lock->writer = true;
+    return ret;
+}
+
+void coop_rwlock_wrunlock(coop_rwlock_t *lock)
+{
+    lock->writer = false;
+    _rw_wake(lock);
+}
+#endif /* CONFIG_OPT_RWLOCK */
+
+#if CONFIG_OPT_BARRIER
+# if !CONFIG_OPT_WAIT
+#  error CONFIG_OPT_BARRIER requires CONFIG_OPT_WAIT
+# endif
+
+coop_error_t coop_barrier_init(coop_barrier_t *bar, int sem_id, unsigned parties)
+{
+    if (!bar || !parties) return COOP_ERR_INV_ARG;
+
+    bar->sem_id = sem_id;
+    bar->parties = parties;
+    bar->arrived = 0;
+    bar->gen = 0;
+    return COOP_SUCCESS;
+}
+
+/**
+ * Barrier generation the waiter arrived at.
+ */
+typedef struct
+{
+    coop_barrier_t *bar;
+    unsigned gen;
+} _bar_wait_ctx_t;
+
+static bool _bar_released(void *ctx)
+{
+    _bar_wait_ctx_t *wait = (_bar_wait_ctx_t*)ctx;
+    return (wait->bar->gen != wait->gen);
+}
+
+coop_error_t coop_barrier_wait(coop_barrier_t *bar, coop_tick_t timeout)
+{
+    _bar_wait_ctx_t wait = { bar, bar->gen };
+    coop_error_t ret;
+
+    if (++bar->arrived >= bar->parties) {
+        coop_dbg_log_cb("Barrier %p: generation %u released by %s\n",
+            (void*)bar, wait.gen, coop_thread_name());
+
+        /* the last arriver releases all the others in one pass */
+        bar->arrived = 0;
+        bar->gen++;
+        coop_notify_all(bar->sem_id);
+        return COOP_SUCCESS;
+    }
+
+    /* generation change can't be missed even if notified before parked */
+    ret = _coop_timed_wait(bar->sem_id, NULL, _bar_released, &wait, timeout);
+
+    if (ret != COOP_SUCCESS) {
+        if (!_bar_released(&wait)) {
+            /* withdraw from the current generation */
+            bar->arrived--;
+        } else {
+            /* released in the meantime */
+            ret = COOP_SUCCESS;
+        }
+    }
+    return ret;
+}
+
+coop_error_t coop_latch_init(coop_latch_t *latch, int sem_id, unsigned count)
+{
+    if (!latch) return COOP_ERR_INV_ARG;
+
+    latch->sem_id = sem_id;
+    latch->count = count;
+    return COOP_SUCCESS;
+}
+
+void coop_latch_count_down(coop_latch_t *latch)
+{
+    if (latch->count > 0 && !--latch->count) {
+        /* release all the waiters in one pass */
+        coop_notify_all(latch->sem_id);
+    }
+}
+
+static bool _latch_open(void *ctx)
+{
+    return !((coop_latch_t*)ctx)->count;
+}
+
+coop_error_t coop_latch_wait(coop_latch_t *latch, coop_tick_t timeout)
+{
+    return _coop_timed_wait(latch->sem_id, NULL, _latch_open, latch, timeout);
+}
+#endif /* CONFIG_OPT_BARRIER */
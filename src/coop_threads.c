@@ -12,12 +12,48 @@
 
 #include <alloca.h>
 #include <setjmp.h>
-#include <string.h> /* memset() */
+#include <stdint.h> /* uintptr_t */
+#include <string.h> /* memset(), memcpy(), strcmp() */
 #include "coop_threads.h"
 
-#if CONFIG_NOEXIT_STATIC_THREADS
+#if CONFIG_NOEXIT_STATIC_THREADS || CONFIG_OPT_HOLE_REUSE
 # include <assert.h>
 #endif
+#if CONFIG_OPT_DYN_POOL
+# include <stdlib.h> /* calloc(), free() */
+#endif
+
+#if CONFIG_OPT_TIMERS && !CONFIG_OPT_IDLE
+# error CONFIG_OPT_TIMERS requires CONFIG_OPT_IDLE
+#endif
+
+#if CONFIG_OPT_WAIT_DEFER_PREDIC && !CONFIG_OPT_WAIT
+# error CONFIG_OPT_WAIT_DEFER_PREDIC requires CONFIG_OPT_WAIT
+#endif
+
+#if CONFIG_OPT_EVGROUPS && !CONFIG_OPT_WAIT
+# error CONFIG_OPT_EVGROUPS requires CONFIG_OPT_WAIT
+#endif
+
+#if CONFIG_OPT_LOAD_STATS && !CONFIG_OPT_IDLE
+# error CONFIG_OPT_LOAD_STATS requires CONFIG_OPT_IDLE
+#endif
+
+#if CONFIG_OPT_EDF && !CONFIG_OPT_IDLE
+# error CONFIG_OPT_EDF requires CONFIG_OPT_IDLE
+#endif
+
+#if CONFIG_OPT_STACK_PROF && !CONFIG_OPT_STACK_WM
+# error CONFIG_OPT_STACK_PROF requires CONFIG_OPT_STACK_WM
+#endif
+
+#if CONFIG_OPT_CANCEL && CONFIG_NOEXIT_STATIC_THREADS
+# error CONFIG_OPT_CANCEL is not supported by CONFIG_NOEXIT_STATIC_THREADS
+#endif
+
+#if CONFIG_OPT_HOLE_REUSE && CONFIG_NOEXIT_STATIC_THREADS
+# error CONFIG_OPT_HOLE_REUSE is not supported by CONFIG_NOEXIT_STATIC_THREADS
+#endif
 
 /** Stack padding byte: 0b10100101 */
 #define STACK_PADD  0xA5
@@ -40,6 +76,9 @@ typedef enum
 #if CONFIG_OPT_WAIT
     WAIT,       /** Waiting thread. */
 #endif
+#if CONFIG_OPT_SUSPEND
+    SUSPENDED,  /** Suspended thread. */
+#endif
 } coop_thrd_state_t;
 
 #if CONFIG_OPT_IDLE
@@ -54,9 +93,76 @@ typedef enum
 # define _IS_WAIT(_state) (0)
 #endif
 
-/* NEW thread is not considered as started */
-#define _IS_STARTED(_state) \
-    ((_state) == RUN || _IS_IDLE(_state) || _IS_WAIT(_state))
+/* scheduler to thread switch clock tick is recorded */
+#define _SWITCH_TICK (CONFIG_OPT_YIELD_AFTER || CONFIG_OPT_QUANTUM || \
+    CONFIG_OPT_LOAD_STATS || CONFIG_OPT_GROUPS || CONFIG_OPT_LONG_SLICE)
+
+/* thread's time-slice is measured while the thread yields or terminates */
+#define _SLICE_END (CONFIG_OPT_QUANTUM || CONFIG_OPT_LOAD_STATS || \
+    CONFIG_OPT_GROUPS || CONFIG_OPT_LONG_SLICE)
+
+/* threads are addressable by their handles */
+#define _THRD_HANDLES \
+    (CONFIG_OPT_SUSPEND || CONFIG_OPT_CANCEL || CONFIG_OPT_MEMPOOL_OWNER)
+
+/**
+ * Thread context - scheduling part.
+ *
+ * The scheduler loop, @c _system_idle() and @c _notify() scan the whole pool
+ * of threads. The scanned fields are kept in a compact structure stored apart
+ * of the rest of the thread context (containing large @c jmp_buf execution
+ * contexts), which makes the scans cache friendly for large pools.
+ */
+typedef struct
+{
+#if CONFIG_OPT_IDLE
+    /** Clock tick the thread is idle up to. */
+    coop_tick_t idle_to;
+#endif
+#if CONFIG_OPT_WAIT
+    /** Clock tick the thread is waiting up to. */
+    coop_tick_t wait_to;
+
+    /** Semaphore id. */
+    int sem_id;
+#endif
+    /** Thread state (@c coop_thrd_state_t). */
+    unsigned char state;
+
+#if CONFIG_OPT_WAIT
+    /** Waiting related flags. */
+    struct {
+        unsigned char notif: 1; /** Notified flag. */
+        unsigned char inf:   1; /** Infinite wait; @c wait_to not applied. */
+        unsigned char any:   1; /** Waiting on multiple semaphore ids. */
+        unsigned char evg:   1; /** Waiting on an event group. */
+# if CONFIG_OPT_WAIT_DEFER_PREDIC
+        unsigned char eval:  1; /** Predicate evaluated by the scheduler. */
+        unsigned char pred:  1; /** Evaluated predicate result. */
+        unsigned char res:   2; /** Reserved. */
+# else
+        unsigned char res:   4; /** Reserved. */
+# endif
+    } wait_flgs;
+#endif
+#if CONFIG_OPT_EDF
+    /** Thread has a deadline; @c deadline applies. */
+    unsigned char dl_set;
+
+    /** Absolute deadline of the thread's current job. */
+    coop_tick_t deadline;
+
+    /** Next thread (index + 1) on the deadlines list; 0 for the list end. */
+    unsigned dl_next;
+#endif
+#if CONFIG_OPT_GROUPS
+    /** Group the thread belongs to. */
+    coop_group_t *grp;
+
+    /** Next thread (index + 1) of the group; 0 for the list end. */
+    unsigned grp_next;
+#endif
+} coop_thrd_hot_t;
 
 /**
  * Thread context.
@@ -76,36 +182,51 @@ typedef struct
     /** User passed argument. */
     void *arg;
 
-    /** Thread state. */
-    coop_thrd_state_t state;
-
-#if CONFIG_OPT_IDLE
-    /** Clock tick the thread is idle up to. */
-    coop_tick_t idle_to;
-#endif
-#if CONFIG_OPT_YIELD_AFTER
+#if _SWITCH_TICK
     /** Scheduler to thread switch clock tick */
     coop_tick_t switch_tick;
 #endif
-#if CONFIG_OPT_WAIT
-    /** Semaphore id. */
-    int sem_id;
+#if CONFIG_OPT_QUANTUM
+    /** Thread time-slice quantum (0: not applied). */
+    coop_tick_t quantum;
+
+    /** Number of time-slices exceeding the quantum. */
+    unsigned overruns;
+#endif
+#if CONFIG_OPT_EDF
+    /** Relative deadline of the thread's jobs (0: no deadline). */
+    coop_tick_t rel_dl;
 
+    /** Number of jobs completed after their deadlines. */
+    unsigned dl_misses;
+#endif
+#if CONFIG_OPT_WAIT
     /** Waiting-predicate routine */
     coop_predic_proc_t predic;
 
+    /** Semaphore ids the thread is waiting on (@c wait_flgs.any set). */
+    const int *sem_ids;
+
+    /** Number of semaphore ids in @c sem_ids. */
+    unsigned sem_n;
+
     /** User defined conditional-variable */
     void *cv;
+#endif
+#if CONFIG_OPT_WAIT_DEFER_PREDIC
+    /** Deferred notifications sequence number at the wait start. */
+    unsigned wait_seq;
+#endif
+#if CONFIG_OPT_EVGROUPS
+    /** Event group the thread is waiting on (@c wait_flgs.evg set). */
+    coop_evgroup_t *evg;
 
-    /** Clock tick the thread is waiting up to. */
-    coop_tick_t wait_to;
+    /** Awaited event bits; event group bits at the wake-up time. */
+    unsigned evg_bits;
 
-    /** Waiting related flags. */
-    struct {
-        unsigned char notif: 1; /** Notified flag. */
-        unsigned char inf:   1; /** Infinite wait; @c wait_to not applied. */
-        unsigned char res:   6; /** Reserved. */
-    } wait_flgs;
+    /** Wait for all awaited bits; clear the bits on the wait exit. */
+    bool evg_all;
+    bool evg_clear;
 #endif
 #if !CONFIG_NOEXIT_STATIC_THREADS
     /**
@@ -116,11 +237,74 @@ typedef struct
 
     /** Thread entry execution context (used for stack unwinding). */
     jmp_buf entry_ctx;
+#endif
+#if CONFIG_OPT_HOLE_REUSE
+    /** Approximated stack pointer at the thread routine entry. */
+    void *entry_sp;
+
+    /** Size of the main stack space occupied by the thread (hole size). */
+    size_t hole_sz;
+
+    /** Thread placed in a hole's stack frame. */
+    bool in_hole;
+
+    /** Hole's overflow canary address (the hole's far end). */
+    unsigned char *hole_cnry;
+#endif
+#if _THRD_HANDLES
+    /** Thread slot generation (@ref coop_thrd_t). */
+    unsigned gen;
+#endif
+#if CONFIG_OPT_CANCEL
+    /** Cancel-pending thread. */
+    bool cancel;
+#endif
+#if CONFIG_OPT_SUSPEND
+    /** Thread state the suspended thread is resumed into. */
+    unsigned char susp_state;
+
+    /** Frozen idle/waiting time-out: remaining ticks. */
+    bool susp_frozen;
+    coop_tick_t susp_rem;
 #endif
     /** Thread execution context. */
     jmp_buf exe_ctx;
+#if CONFIG_OPT_DYN_POOL
+    /** Next slot on the chunk's free-slots list (EMPTY slots only). */
+    unsigned next_free;
+#endif
 } coop_thrd_ctx_t;
 
+#if CONFIG_OPT_DYN_POOL
+/** Maximum number of chunks constituting the threads pool. */
+# define _CHUNKS_MAX \
+    ((CONFIG_MAX_THREADS + CONFIG_DYN_POOL_CHUNK - 1) / CONFIG_DYN_POOL_CHUNK)
+
+/** Free-slots list terminator. */
+# define _NO_SLOT ((unsigned)-1)
+
+/**
+ * Threads pool chunk. Chunks are allocated on demand and released while not
+ * used anymore. Thread context index @c i is located on the chunk number
+ * @c i / @c CONFIG_DYN_POOL_CHUNK, therefore stays stable for the whole
+ * thread's lifespan.
+ */
+typedef struct
+{
+    /** Number of occupied (non empty) thread slots on the chunk. */
+    unsigned busy_n;
+
+    /** Head of the chunk's free-slots list (index within the chunk). */
+    unsigned free_head;
+
+    /** Chunk's pool of contexts (scheduling part). */
+    coop_thrd_hot_t hot[CONFIG_DYN_POOL_CHUNK];
+
+    /** Chunk's pool of contexts. */
+    coop_thrd_ctx_t thrds[CONFIG_DYN_POOL_CHUNK];
+} coop_pool_chunk_t;
+#endif
+
 /**
  * Scheduler context.
  */
@@ -136,6 +320,38 @@ typedef struct
     /** Number of idle and waiting threads. */
     unsigned idle_n;
 #endif
+#if CONFIG_OPT_WAIT_DEFER_PREDIC
+    /** Deferred notifications queue (ring buffer). */
+    struct {
+        /** Notified semaphore id. */
+        int sem_id;
+
+        /** Number of single-notifications; 0 for notify-all. */
+        unsigned single_n;
+
+        /** Notification sequence number. */
+        unsigned seq;
+    } notif_q[CONFIG_WAIT_DEFER_QUEUE];
+
+    /** Oldest queued notification index; number of queued notifications. */
+    unsigned notif_head;
+    volatile unsigned notif_n;
+
+    /** Next sequence number of deferred notifications and waits start. */
+    unsigned notif_seq;
+
+    /** Queue overflow mark; sequence number of the latest lost notification. */
+    volatile bool notif_ovf;
+    unsigned notif_ovf_seq;
+#endif
+#if CONFIG_OPT_TIMERS
+    /** Active timers list (sorted by expiration ticks). */
+    coop_timer_t *timers;
+#endif
+#if CONFIG_OPT_EDF
+    /** Threads with a deadline (index + 1) sorted by their deadlines. */
+    unsigned dl_head;
+#endif
 #if !CONFIG_NOEXIT_STATIC_THREADS
     /** Number of holes (terminated threads occupying the main stack). */
     unsigned hole_n;
@@ -146,12 +362,136 @@ typedef struct
     /** Scheduler execution context. */
     jmp_buf exe_ctx;
 
+#if CONFIG_OPT_DYN_POOL
+    /** Number of allocated chunks. */
+    unsigned chunks_n;
+
+    /** Lowest chunk with free slots (hint; may point to a full chunk). */
+    unsigned free_chunk;
+
+    /** Threads pool chunks. */
+    coop_pool_chunk_t *chunks[_CHUNKS_MAX];
+#else
+    /** Threads pool of contexts (scheduling part). */
+    coop_thrd_hot_t hot[CONFIG_MAX_THREADS];
+
     /** Threads pool of contexts. */
     coop_thrd_ctx_t thrds[CONFIG_MAX_THREADS];
+#endif
 } coop_sched_ctx_t;
 
+#if CONFIG_OPT_LOAD_STATS
+/**
+ * CPU load sliding-window bucket.
+ */
+typedef struct
+{
+    /** Bucket's time-frame number (tick / @c CONFIG_LOAD_BUCKET_TICKS). */
+    coop_tick_t frame;
+
+    /** Idle and threads run ticks accounted in the time-frame. */
+    coop_tick_t idle;
+    coop_tick_t run;
+} coop_load_bucket_t;
+
+/**
+ * Load accounting context. Kept apart of the scheduler context, therefore
+ * not reset on the scheduler exit.
+ */
+static struct
+{
+    /** Cumulative statistics. */
+    coop_load_stats_t stats;
+
+    /** Sliding-window buckets. */
+    coop_load_bucket_t buckets[CONFIG_LOAD_WINDOW_BUCKETS];
+} load;
+#endif
+
+#if CONFIG_OPT_GROUPS
+/**
+ * Threads groups context. Kept apart of the scheduler context, therefore
+ * not reset on the scheduler exit.
+ */
+static struct
+{
+    /** Initialized groups list. */
+    coop_group_t *list;
+
+    /** Current accounting round start tick. */
+    coop_tick_t round_start;
+
+    /** Most under-budget top-level group with threads. */
+    coop_group_t *top_min;
+
+    /** Default top-level group of weight 1. */
+    coop_group_t dflt;
+} groups = {
+    /* the rest of the fields is zeroed */
+    .dflt = { .name = NULL, .parent = NULL, .depth = 0, .weight = 1 }
+};
+#endif
+
+#if CONFIG_OPT_LONG_SLICE
+/**
+ * Long time-slices detector. Kept apart of the scheduler context, therefore
+ * not reset on the scheduler exit.
+ */
+static struct
+{
+    /** Long time-slice callback. */
+    coop_long_slice_cb_t cb;
+
+    /** Time-slice threshold. */
+    coop_tick_t threshold;
+} long_slice = { NULL, CONFIG_LONG_SLICE_TICKS };
+#endif
+
+#if CONFIG_OPT_HOOKS
+/** Installed scheduler event hooks. */
+static const coop_hooks_t *hooks = NULL;
+
+# define _HOOK(_h, _args) \
+    do { if (hooks && hooks->_h) hooks->_h _args; } while (0)
+#else
+# define _HOOK(_h, _args)
+#endif
+
+#if CONFIG_OPT_STACK_PROF
+/**
+ * Stack-size profiler context. Kept apart of the scheduler context, therefore
+ * not reset on the scheduler exit.
+ */
+static struct
+{
+    /** Number of used records. */
+    unsigned n;
+
+    coop_stack_prof_t recs[CONFIG_STACK_PROF_ENTRIES];
+} stack_prof;
+#endif
+
 static coop_sched_ctx_t sched = {0};
 
+#if _THRD_HANDLES
+/** Threads slots generation counter. Not reset on the scheduler exit. */
+static unsigned thrd_gen = 0;
+#endif
+
+#if CONFIG_OPT_DYN_POOL
+# define _HOT(_i) \
+    (sched.chunks[(_i) / CONFIG_DYN_POOL_CHUNK]->hot[(_i) % CONFIG_DYN_POOL_CHUNK])
+# define _THRD(_i) \
+    (sched.chunks[(_i) / CONFIG_DYN_POOL_CHUNK]->thrds[(_i) % CONFIG_DYN_POOL_CHUNK])
+
+/* number of currently available thread slots */
+# define _POOL_SIZE() (sched.chunks_n * CONFIG_DYN_POOL_CHUNK)
+#else
+# define _HOT(_i) (sched.hot[_i])
+# define _THRD(_i) (sched.thrds[_i])
+# define _POOL_SIZE() (CONFIG_MAX_THREADS)
+#endif
+
 #if CONFIG_NOEXIT_STATIC_THREADS
 # define _ACTIVE_THREADS() (sched.busy_n)
 #else
@@ -161,7 +501,7 @@ static coop_sched_ctx_t sched = {0};
 #if COOP_DEBUG
 static const char *_state_name(unsigned i)
 {
-    switch (sched.thrds[i].state)
+    switch (_HOT(i).state)
     {
     case EMPTY:
         return "EMPTY";
@@ -180,152 +520,1031 @@ static const char *_state_name(unsigned i)
 # if CONFIG_OPT_WAIT
     case WAIT:
         return "WAIT";
+# endif
+# if CONFIG_OPT_SUSPEND
+    case SUSPENDED:
+        return "SUSPENDED";
 # endif
     }
     return "???";
 }
 #endif
 
-static inline void _sched_init(bool force)
+#if CONFIG_OPT_DYN_POOL
+/**
+ * Allocate an EMPTY thread slot. The pool is extended by a new chunk if
+ * there is no free slots on already allocated chunks.
+ *
+ * Return slot index or @c _NO_SLOT if no memory is available.
+ */
+static unsigned _pool_alloc(void)
 {
-    static bool inited = false;
+    unsigned c, i;
+    coop_pool_chunk_t *chunk;
 
-    if (!inited || force) {
-        inited = true;
-        memset(&sched, 0, sizeof(sched));
-        sched.cur_thrd = (unsigned)-1;
+    /* free slots are taken from the lowest chunk possible; this way the
+       chunks on the pool's tail are more likely to be released */
+    for (c = sched.free_chunk; c < sched.chunks_n; c++) {
+        if (sched.chunks[c]->free_head != _NO_SLOT) break;
     }
-}
+    sched.free_chunk = c;
 
-/*
- * NOTE: to reduce stack usage by coop_sched_service() helper routines, these
- * are defined as inline with all their local variables stored in registers.
- */
+    if (c >= sched.chunks_n)
+    {
+        if (c >= _CHUNKS_MAX ||
+            !(chunk = (coop_pool_chunk_t*)calloc(1, sizeof(*chunk))))
+        {
+            return _NO_SLOT;
+        }
+
+        for (i = 0; i < CONFIG_DYN_POOL_CHUNK; i++) {
+            chunk->thrds[i].next_free =
+                (i + 1 < CONFIG_DYN_POOL_CHUNK ? i + 1 : _NO_SLOT);
+        }
+        sched.chunks[c] = chunk;
+        sched.chunks_n++;
+
+        coop_dbg_log_cb("Pool extended to %d slots\n", _POOL_SIZE());
+    }
+
+    chunk = sched.chunks[c];
+    i = chunk->free_head;
+    chunk->free_head = chunk->thrds[i].next_free;
+    chunk->busy_n++;
+
+    return c * CONFIG_DYN_POOL_CHUNK + i;
+}
 
-#if !CONFIG_NOEXIT_STATIC_THREADS
 /**
- * Mark threads whose stacks need to be unwinded.
+ * Release pool's tail chunks not used anymore. A single empty chunk is left
+ * on the tail to avoid excessive memory reallocation for bursty workloads.
  *
- * Return terminated thread index at which the unwinded stack shall finish.
- * The new scheduler stack frame will be set at the thread context after the
- * unwinding process completes.
+ * The routine is not called by _thrd_free() since a freed slot's context may
+ * still be in use (e.g. its entry context the stack is unwound to). Instead
+ * it's called from the scheduler loop with no slot context in use: after the
+ * main stack unwind (the only path releasing started threads slots), on an
+ * unexpected static thread exit and before the system goes idle.
  */
-static inline unsigned _mark_unwind_thrds()
+static void _pool_shrink(void)
 {
-    register unsigned i, depth, unwnd_thrd = sched.cur_thrd;
+    while (sched.chunks_n > 1 &&
+        !sched.chunks[sched.chunks_n - 1]->busy_n &&
+        !sched.chunks[sched.chunks_n - 2]->busy_n)
+    {
+        sched.chunks_n--;
+        free(sched.chunks[sched.chunks_n]);
+        sched.chunks[sched.chunks_n] = NULL;
 
-    /* mark the terminating (most shallow) thread as EMPTY */
-    coop_dbg_log_cb("Thread #%d: RUN -> EMPTY\n", sched.cur_thrd);
-    sched.thrds[sched.cur_thrd].state = EMPTY;
+        coop_dbg_log_cb("Pool shrunk to %d slots\n", _POOL_SIZE());
+    }
+    if (sched.free_chunk > sched.chunks_n)
+        sched.free_chunk = sched.chunks_n;
+}
+#endif /* CONFIG_OPT_DYN_POOL */
+
+/**
+ * Mark thread slot as EMPTY.
+ */
+static inline void _thrd_free(unsigned i)
+{
+    _HOT(i).state = EMPTY;
     sched.busy_n--;
 
-    /* calculate current main stack depth */
-    for (i = depth = 0; i < CONFIG_MAX_THREADS; i++) {
-        if (_IS_STARTED(sched.thrds[i].state)) {
-            if (depth < sched.thrds[i].depth)
-                depth = sched.thrds[i].depth;
-        }
+#if CONFIG_OPT_DYN_POOL
+    {
+        coop_pool_chunk_t *chunk = sched.chunks[i / CONFIG_DYN_POOL_CHUNK];
+
+        chunk->thrds[i % CONFIG_DYN_POOL_CHUNK].next_free = chunk->free_head;
+        chunk->free_head = i % CONFIG_DYN_POOL_CHUNK;
+        chunk->busy_n--;
+
+        if (sched.free_chunk > i / CONFIG_DYN_POOL_CHUNK)
+            sched.free_chunk = i / CONFIG_DYN_POOL_CHUNK;
     }
+#endif
+}
 
-    if (depth + 1 < sched.depth)
-    {
-        /*
-         * All holes between the terminating thread and the most shallow
-         * started thread are marked as EMPTY to indicate stack space occupied
-         * by these threads stacks as to be freed.
-         */
-        for (i = 0; i < CONFIG_MAX_THREADS; i++) {
-            if (sched.thrds[i].state == HOLE) {
-                if (depth + 1 <= sched.thrds[i].depth)
-                {
-                    if (depth + 1 == sched.thrds[i].depth) {
-                        unwnd_thrd = i;
-                    }
-                    coop_dbg_log_cb("Thread #%d: HOLE -> EMPTY\n", i);
-                    sched.thrds[i].state = EMPTY;
-                    sched.busy_n--;
-                    sched.hole_n--;
-                }
-            }
-        }
+#if CONFIG_OPT_HOLE_REUSE
+/** @c entry_ctx jump: start a new thread in a hole's stack frame */
+# define _JMP_HOLE_ENTRY 2
+
+/** Hole's overflow canary pattern */
+# define _HOLE_CANARY 0xC0A5C0A5UL
+
+/**
+ * Get approximated stack pointer of the calling routine.
+ */
+# ifdef __GNUC__
+__attribute__((noinline)) static void *_stack_ptr(void)
+{
+    return __builtin_frame_address(0);
+}
+# else
+static void *_stack_ptr(void)
+{
+    volatile char sp = 0;
+    volatile uintptr_t addr = (uintptr_t)&sp;
+    return (void*)addr;
+}
+# endif
+
+/**
+ * Calculate main stack space occupied by a terminated thread (turning into
+ * a hole). The space is spread between the thread routine entry and the end
+ * of the thread stack, where the next thread's stack frame begins.
+ */
+static void _hole_size(unsigned i)
+{
+    uint32_t cnry = _HOLE_CANARY;
+    unsigned char *entry = (unsigned char*)_THRD(i).entry_sp;
+    unsigned char *stack = (unsigned char*)_THRD(i).stack;
+
+    if (_THRD(i).in_hole) {
+        /* the hole's size and canary address have been already calculated */
+    } else
+    if (!stack) {
+        _THRD(i).hole_sz = 0;
+    } else
+    if (stack < entry) {
+        /* stack growing into lower addresses */
+        _THRD(i).hole_sz = (size_t)(entry - stack);
+        _THRD(i).hole_cnry = stack;
     } else {
-        /*
-         * No hole between the most shallow started thread and the terminating
-         * thread. Unwinded stack will be set to the terminating thread stack.
-         */
+        _THRD(i).hole_sz = (size_t)(stack + _THRD(i).stack_sz - entry);
+        _THRD(i).hole_cnry = stack + _THRD(i).stack_sz - sizeof(cnry);
     }
-    sched.depth = depth;
 
-    return unwnd_thrd;
+    /* the hole's space is no longer used; set the canary */
+    if (_THRD(i).hole_sz >= sizeof(cnry))
+        memcpy(_THRD(i).hole_cnry, &cnry, sizeof(cnry));
+
+    coop_dbg_log_cb("Thread #%d: hole size %lu\n",
+        i, (unsigned long)_THRD(i).hole_sz);
 }
-#endif
 
-#if CONFIG_OPT_IDLE
 /**
- * Check conditions and enter the system idle state if necessary.
+ * Fail fast if thread @c i placed in a hole has overflowed the hole (the
+ * hole's canary is overwritten) or is going to overflow it. On the thread's
+ * first yield @c first is set: stack frames built from the thread routine
+ * entry up to this point and the thread stack to be allocated must fit in
+ * the hole.
  */
-static inline void _system_idle(void)
+static void _hole_check(unsigned i, bool first)
 {
-    register unsigned i = 0;
-    register coop_tick_t min_idle = 0, cur_tick = 0;
+    uint32_t cnry;
+    size_t used = sizeof(cnry);
 
-    /* system is considered idle-ready if all active threads are idle or waiting */
-    while (sched.idle_n > 0 && _ACTIVE_THREADS() <= sched.idle_n)
+    if (first) {
+        unsigned char *entry = (unsigned char*)_THRD(i).entry_sp;
+        unsigned char *sp = (unsigned char*)_stack_ptr();
+
+        used += (size_t)(sp < entry ? entry - sp : sp - entry) +
+            _THRD(i).stack_sz;
+    }
+
+    memcpy(&cnry, _THRD(i).hole_cnry, sizeof(cnry));
+    if (cnry != _HOLE_CANARY || used > _THRD(i).hole_sz)
     {
-        if (i) {
-            /* min_idle was set in the previous loop pass */
-# if COOP_DEBUG
-            if (min_idle == COOP_MAX_TICK) {
-                coop_dbg_log_cb("System going idle infinitely\n");
-            } else {
-                coop_dbg_log_cb("System going idle for %lu ticks\n",
-                    (unsigned long)min_idle);
-            }
+        coop_dbg_log_cb("UNEXPECTED: Thread #%d overflows its hole; "
+            "used %lu of %lu\n", i, (unsigned long)used,
+            (unsigned long)_THRD(i).hole_sz);
+        assert(false);
+    }
+}
+
+/**
+ * Find the best-fit hole for a new thread with stack size @c stack_sz.
+ * Return the hole index or @c (unsigned)-1 if not found.
+ */
+static unsigned _hole_find(size_t stack_sz)
+{
+    unsigned i, hole = (unsigned)-1;
+
+    if (!sched.hole_n) return hole;
+
+    for (i = 0; i < _POOL_SIZE(); i++) {
+        if (_HOT(i).state == HOLE &&
+            _THRD(i).hole_sz >= stack_sz + CONFIG_HOLE_REUSE_MARGIN &&
+            (hole == (unsigned)-1 || _THRD(i).hole_sz < _THRD(hole).hole_sz))
+        {
+            hole = i;
+        }
+    }
+    return hole;
+}
+#endif /* CONFIG_OPT_HOLE_REUSE */
+
+#if CONFIG_OPT_CANCEL
+/** @c entry_ctx jump: terminate canceled thread */
+# define _JMP_CANCEL 3
+#endif
+
+static inline void _sched_init(bool force)
+{
+    static bool inited = false;
+
+    if (!inited || force) {
+#if CONFIG_OPT_DYN_POOL
+        while (sched.chunks_n > 0) {
+            free(sched.chunks[--sched.chunks_n]);
+        }
+#endif
+        inited = true;
+        memset(&sched, 0, sizeof(sched));
+        sched.cur_thrd = (unsigned)-1;
+    }
+}
+
+/*
+ * NOTE: to reduce stack usage by coop_sched_service() helper routines, these
+ * are defined as inline with all their local variables stored in registers.
+ */
+
+#if CONFIG_OPT_LOAD_STATS
+/* sliding-window span in ticks */
+# define _LOAD_WINDOW (CONFIG_LOAD_WINDOW_BUCKETS * CONFIG_LOAD_BUCKET_TICKS)
+
+/**
+ * Account ticks period [start, end) as idle or threads run time in the
+ * sliding-window buckets.
+ */
+static void _load_account(coop_tick_t start, coop_tick_t end, bool idle)
+{
+    coop_tick_t frame, span;
+    coop_load_bucket_t *bucket;
+
+    /* periods older than the window are not needed */
+    if (end - start > _LOAD_WINDOW) start = end - _LOAD_WINDOW;
+
+    while (start != end)
+    {
+        frame = start / CONFIG_LOAD_BUCKET_TICKS;
+        span = CONFIG_LOAD_BUCKET_TICKS - start % CONFIG_LOAD_BUCKET_TICKS;
+        if (span > end - start) span = end - start;
+
+        bucket = &load.buckets[frame % CONFIG_LOAD_WINDOW_BUCKETS];
+        if (bucket->frame != frame) {
+            /* stale bucket reused for the new time-frame */
+            bucket->frame = frame;
+            bucket->idle = bucket->run = 0;
+        }
+
+        if (idle) {
+            bucket->idle += span;
+        } else {
+            bucket->run += span;
+        }
+        start += span;
+    }
+}
+
+/**
+ * Switch the system into the idle state with idle time accounting.
+ */
+static inline void _load_idle_cb(coop_tick_t period)
+{
+    register coop_tick_t start = coop_tick_cb(), end;
+
+    coop_idle_cb(period);
+    end = coop_tick_cb();
+
+    load.stats.idle_n++;
+    load.stats.idle_ticks += end - start;
+    if (period) {
+        load.stats.idle_req_ticks += period;
+        load.stats.idle_fin_ticks += end - start;
+    } else {
+        load.stats.idle_inf_n++;
+    }
+    _load_account(start, end, true);
+}
+#endif /* CONFIG_OPT_LOAD_STATS */
+
+#if CONFIG_OPT_GROUPS
+/**
+ * Update threads count of a group and its ancestors.
+ */
+static inline void _grp_thrd_n(coop_group_t *grp, bool inc)
+{
+    for (; grp; grp = grp->parent) {
+        if (inc) grp->thrd_n++;
+        else grp->thrd_n--;
+    }
+}
+
+/**
+ * Add i-th thread to its group.
+ */
+static void _grp_add(unsigned i)
+{
+    coop_group_t *grp = _HOT(i).grp;
+
+    _HOT(i).grp_next = grp->thrds;
+    grp->thrds = i + 1;
+    _grp_thrd_n(grp, true);
+}
+
+/**
+ * Remove i-th thread from its group.
+ */
+static void _grp_del(unsigned i)
+{
+    register unsigned *next = &_HOT(i).grp->thrds;
+
+    while (*next && *next != i + 1) next = &_HOT(*next - 1).grp_next;
+    if (*next) *next = _HOT(i).grp_next;
+    _grp_thrd_n(_HOT(i).grp, false);
+}
+
+/**
+ * Account i-th thread's time-slice to its group and the group's ancestors.
+ */
+static inline void _grp_account(
+    unsigned i, coop_tick_t slice, coop_tick_t cur_tick)
+{
+    register coop_group_t *grp;
+
+    if (cur_tick - groups.round_start >= CONFIG_GROUPS_ROUND_TICKS)
+    {
+        /* new accounting round */
+        groups.round_start = cur_tick;
+        groups.dflt.run_ticks = 0;
+        for (grp = groups.list; grp; grp = grp->next) grp->run_ticks = 0;
+    }
+
+    for (grp = _HOT(i).grp; grp; grp = grp->parent) {
+        grp->run_ticks += slice;
+        grp->total_ticks += slice;
+    }
+}
+#endif
+
+#if _SLICE_END
+/**
+ * Thread's time-slice ends (the thread yields or terminates).
+ */
+static inline void _slice_end(unsigned i)
+{
+    register coop_tick_t cur_tick = coop_tick_cb();
+    register coop_tick_t slice = cur_tick - _THRD(i).switch_tick;
+
+# if CONFIG_OPT_QUANTUM
+    if (_THRD(i).quantum && slice > _THRD(i).quantum) {
+        coop_dbg_log_cb("Thread #%d quantum overrun; time-slice %lu ticks\n",
+            i, (unsigned long)slice);
+        _THRD(i).overruns++;
+    }
+# endif
+# if CONFIG_OPT_LOAD_STATS
+    load.stats.run_ticks += slice;
+    _load_account(_THRD(i).switch_tick, cur_tick, false);
+# endif
+# if CONFIG_OPT_GROUPS
+    _grp_account(i, slice, cur_tick);
+# endif
+# if CONFIG_OPT_LONG_SLICE
+    if (long_slice.cb && slice > long_slice.threshold) {
+        coop_dbg_log_cb("Thread #%d long time-slice %lu ticks\n",
+            i, (unsigned long)slice);
+        long_slice.cb(_THRD(i).name, slice);
+    }
+# endif
+    (void)slice;
+}
+#endif
+
+#if !CONFIG_NOEXIT_STATIC_THREADS
+/**
+ * Mark threads whose stacks need to be unwinded.
+ *
+ * Return terminated thread index at which the unwinded stack shall finish.
+ * The new scheduler stack frame will be set at the thread context after the
+ * unwinding process completes.
+ */
+static inline unsigned _mark_unwind_thrds()
+{
+    register unsigned i, depth, unwnd_thrd = sched.cur_thrd;
+
+    /* mark the terminating (most shallow) thread as EMPTY */
+    coop_dbg_log_cb("Thread #%d: RUN -> EMPTY\n", sched.cur_thrd);
+    _thrd_free(sched.cur_thrd);
+
+    /*
+     * Calculate current main stack depth. Not started threads have depth set
+     * to 0 unless placed in a hole, whose stack frame they occupy.
+     */
+    for (i = depth = 0; i < _POOL_SIZE(); i++) {
+        if (_HOT(i).state != EMPTY && _HOT(i).state != HOLE) {
+            if (depth < _THRD(i).depth)
+                depth = _THRD(i).depth;
+        }
+    }
+
+    if (depth + 1 < sched.depth)
+    {
+        /*
+         * All holes between the terminating thread and the most shallow
+         * started thread are marked as EMPTY to indicate stack space occupied
+         * by these threads stacks as to be freed.
+         */
+        for (i = 0; i < _POOL_SIZE(); i++) {
+            if (_HOT(i).state == HOLE) {
+                if (depth + 1 <= _THRD(i).depth)
+                {
+                    if (depth + 1 == _THRD(i).depth) {
+                        unwnd_thrd = i;
+                    }
+                    coop_dbg_log_cb("Thread #%d: HOLE -> EMPTY\n", i);
+                    _thrd_free(i);
+                    sched.hole_n--;
+                }
+            }
+        }
+    } else {
+        /*
+         * No hole between the most shallow started thread and the terminating
+         * thread. Unwinded stack will be set to the terminating thread stack.
+         */
+    }
+    sched.depth = depth;
+
+    return unwnd_thrd;
+}
+#endif
+
+#if CONFIG_OPT_TIMERS
+/**
+ * Insert timer on the active timers list (sorted by expiration ticks).
+ */
+static void _timer_insert(coop_timer_t *timer)
+{
+    coop_timer_t **pt = &sched.timers;
+
+    for (; *pt && COOP_IS_TICK_OVER(timer->expire, (*pt)->expire);
+        pt = &(*pt)->next);
+
+    timer->next = *pt;
+    *pt = timer;
+}
+
+/**
+ * Remove timer from the active timers list.
+ */
+static void _timer_remove(coop_timer_t *timer)
+{
+    coop_timer_t **pt = &sched.timers;
+
+    for (; *pt && *pt != timer; pt = &(*pt)->next);
+    if (*pt) *pt = timer->next;
+}
+
+/**
+ * Run expired timers callbacks.
+ */
+static void _timers_run(coop_tick_t cur_tick)
+{
+    coop_timer_t *timer;
+
+    while ((timer = sched.timers) != NULL &&
+        COOP_IS_TICK_OVER(cur_tick, timer->expire))
+    {
+        sched.timers = timer->next;
+
+        if (timer->periodic) {
+            /* next expiration is calculated relatively to the previous one
+               (no drift caused by the callback execution time) */
+            timer->expire += timer->period;
+            _timer_insert(timer);
+        } else {
+            timer->active = false;
+        }
+
+        coop_dbg_log_cb("Timer %p expired\n", (void*)timer);
+        timer->cb(timer->arg);
+    }
+}
+#endif /* CONFIG_OPT_TIMERS */
+
+#if CONFIG_OPT_WAIT_DEFER_PREDIC
+/**
+ * Get predicate result of waiting thread @c i. Predicate of each distinct
+ * (predicate, cv) pair is evaluated once while processing deferred
+ * notifications.
+ */
+static bool _predic_get(unsigned i)
+{
+    register unsigned j;
+
+    if (!_HOT(i).wait_flgs.eval)
+    {
+        _HOT(i).wait_flgs.pred = _THRD(i).predic(_THRD(i).cv);
+        _HOT(i).wait_flgs.eval = 1;
+
+        /* the result applies to all waiters with the same predicate */
+        for (j = i + 1; j < _POOL_SIZE(); j++) {
+            if (_IS_WAIT(_HOT(j).state) && _THRD(j).predic &&
+                _THRD(j).predic == _THRD(i).predic &&
+                _THRD(j).cv == _THRD(i).cv)
+            {
+                _HOT(j).wait_flgs.pred = _HOT(i).wait_flgs.pred;
+                _HOT(j).wait_flgs.eval = 1;
+            }
+        }
+    }
+    return _HOT(i).wait_flgs.pred;
+}
+
+/* deferred notifications or the queue overflow pending */
+# define _NOTIF_PENDING() (sched.notif_n || sched.notif_ovf)
+
+static inline bool _sem_match(unsigned i, int sem_id);
+static inline bool _notify(int sem_id, bool single, unsigned seq);
+static void _notify_ovf(unsigned seq);
+
+/**
+ * Process queued deferred notifications in their order. Each notification
+ * is handled as it would be handled by the notifying routine, except the
+ * threads started waiting after the notification was sent are not woken-up.
+ * The queue is shared with the notifying routines (possibly ISRs), therefore
+ * its entries are fetched in the ISR critical section.
+ */
+static void _notify_deferred(void)
+{
+    register unsigned i;
+    int sem_id;
+    unsigned single_n, seq, isr;
+    bool ovf;
+
+    for (;;)
+    {
+        isr = coop_isr_lock_cb();
+        if (!sched.notif_n) {
+            ovf = sched.notif_ovf;
+            seq = sched.notif_ovf_seq;
+            sched.notif_ovf = false;
+            coop_isr_unlock_cb(isr);
+            break;
+        }
+
+        sem_id = sched.notif_q[sched.notif_head].sem_id;
+        single_n = sched.notif_q[sched.notif_head].single_n;
+        seq = sched.notif_q[sched.notif_head].seq;
+
+        sched.notif_head = (sched.notif_head + 1) % CONFIG_WAIT_DEFER_QUEUE;
+        sched.notif_n--;
+        coop_isr_unlock_cb(isr);
+
+        if (!single_n) {
+            _notify(sem_id, false, seq);
+        } else {
+            /* no more waiters to wake-up if a single-notify failed */
+            while (single_n-- && _notify(sem_id, true, seq));
+        }
+    }
+
+    if (ovf) {
+        coop_dbg_log_cb("Deferred notifications queue overflowed\n");
+        _notify_ovf(seq);
+    }
+
+    /* predicates are evaluated again for next notifications */
+    for (i = 0; i < _POOL_SIZE(); i++) {
+        _HOT(i).wait_flgs.eval = 0;
+    }
+}
+#endif /* CONFIG_OPT_WAIT_DEFER_PREDIC */
+
+#if CONFIG_OPT_IDLE
+# if CONFIG_OPT_TIMERS
+/* active timers keep the system running even with no threads scheduled */
+#  define _IDLE_PENDING() (sched.idle_n > 0 || sched.timers)
+# else
+#  define _IDLE_PENDING() (sched.idle_n > 0)
+# endif
+
+/**
+ * Check conditions and enter the system idle state if necessary.
+ */
+static inline void _system_idle(void)
+{
+    register unsigned i;
+    register bool min_idle_set = false;
+    register coop_tick_t min_idle = 0, cur_tick = 0;
+
+    /* system is considered idle-ready if all active threads are idle or waiting */
+    while (_IDLE_PENDING() && _ACTIVE_THREADS() <= sched.idle_n)
+    {
+        if (min_idle_set) {
+            /* min_idle was set in the previous loop pass */
+# if COOP_DEBUG
+            if (min_idle == COOP_MAX_TICK) {
+                coop_dbg_log_cb("System going idle infinitely\n");
+            } else {
+                coop_dbg_log_cb("System going idle for %lu ticks\n",
+                    (unsigned long)min_idle);
+            }
+# endif
+# if CONFIG_OPT_DYN_POOL
+            /* release unused pool chunks before the system goes idle */
+            _pool_shrink();
 # endif
             /* system is idle up to nearest wake-up time */
+            _HOOK(idle_enter, (min_idle == COOP_MAX_TICK ? 0 : min_idle));
+# if CONFIG_OPT_LOAD_STATS
+            _load_idle_cb(min_idle == COOP_MAX_TICK ? 0 : min_idle);
+# else
             coop_idle_cb(min_idle == COOP_MAX_TICK ? 0 : min_idle);
+# endif
+            _HOOK(idle_exit, ());
+        }
+
+        min_idle = COOP_MAX_TICK;
+        cur_tick = coop_tick_cb();  /* current tick */
+        min_idle_set = true;
+
+# if CONFIG_OPT_TIMERS
+        if (sched.timers) {
+            _timers_run(cur_tick);
+
+            /* nearest timer expiration is a wake-up time candidate */
+            if (sched.timers)
+                min_idle = sched.timers->expire - cur_tick;
+        }
+# endif
+# if CONFIG_OPT_WAIT_DEFER_PREDIC
+        /* threads notified while the system was idle or by timers */
+        if (_NOTIF_PENDING()) _notify_deferred();
+# endif
+        for (i = 0; i < _POOL_SIZE(); i++)
+        {
+            if (_IS_IDLE(_HOT(i).state)
+# if CONFIG_OPT_WAIT
+                || (_IS_WAIT(_HOT(i).state) &&
+                    !_HOT(i).wait_flgs.inf)
+# endif
+                )
+            {
+                register coop_tick_t idle_to = (
+# if CONFIG_OPT_WAIT
+                    !_IS_IDLE(_HOT(i).state) ? _HOT(i).wait_to :
+# endif
+                    _HOT(i).idle_to);
+
+                if (COOP_IS_TICK_OVER(cur_tick, idle_to)) {
+                    coop_dbg_log_cb("Thread #%d %s -> RUN (via idle-loop)\n",
+                        i, _state_name(i));
+
+                    /* idle time passed; the idle-loop will be finished */
+                    _HOT(i).state = RUN;
+                    sched.idle_n--;
+                } else
+                if ((idle_to - cur_tick) < min_idle) {
+                    /* calculate nearest wake-up time */
+                    min_idle = (idle_to - cur_tick);
+                }
+            }
+        }
+    }
+}
+#endif /* CONFIG_OPT_IDLE */
+
+#if CONFIG_OPT_EDF || CONFIG_OPT_GROUPS
+/* distance of i-th thread from the current one in the round-robin order */
+# define _RR_DIST(_i) \
+    (((_i) + _POOL_SIZE() - sched.cur_thrd - 1) % _POOL_SIZE())
+
+/**
+ * Check if i-th thread is runnable at a given tick.
+ */
+static inline bool _thrd_runnable(unsigned i, coop_tick_t cur_tick)
+{
+    switch (_HOT(i).state)
+    {
+    case NEW:
+    case RUN:
+        return true;
+# if CONFIG_OPT_IDLE
+    case IDLE:
+        return COOP_IS_TICK_OVER(cur_tick, _HOT(i).idle_to);
+# endif
+# if CONFIG_OPT_WAIT
+    case WAIT:
+        return (!_HOT(i).wait_flgs.inf &&
+            COOP_IS_TICK_OVER(cur_tick, _HOT(i).wait_to));
+# endif
+    default:
+        (void)cur_tick;
+        return false;
+    }
+}
+#endif
+
+#if CONFIG_OPT_EDF
+/**
+ * Put i-th thread on the deadlines list, behind the threads with the same
+ * deadline.
+ */
+static void _dl_insert(unsigned i)
+{
+    register unsigned *next = &sched.dl_head;
+
+    while (*next &&
+        COOP_IS_TICK_OVER(_HOT(i).deadline, _HOT(*next - 1).deadline))
+    {
+        next = &_HOT(*next - 1).dl_next;
+    }
+    _HOT(i).dl_next = *next;
+    *next = i + 1;
+}
+
+/**
+ * Remove i-th thread from the deadlines list.
+ */
+static void _dl_remove(unsigned i)
+{
+    register unsigned *next = &sched.dl_head;
+
+    while (*next && *next != i + 1) next = &_HOT(*next - 1).dl_next;
+    if (*next) *next = _HOT(i).dl_next;
+}
+
+/**
+ * Thread's job completes (the thread yields or terminates). Deadline miss
+ * is recorded if the job completes after its deadline.
+ */
+static inline void _job_end(unsigned i, coop_tick_t cur_tick)
+{
+    if (_HOT(i).dl_set && !COOP_IS_TICK_OVER(_HOT(i).deadline, cur_tick)) {
+        coop_dbg_log_cb("Thread #%d missed deadline by %lu ticks\n",
+            i, (unsigned long)(cur_tick - _HOT(i).deadline));
+        _THRD(i).dl_misses++;
+    }
+}
+
+/**
+ * Thread's current job completes and the next one is released at @c release
+ * tick.
+ */
+static inline void _job_next(
+    unsigned i, coop_tick_t cur_tick, coop_tick_t release)
+{
+    _job_end(i, cur_tick);
+
+    if (_HOT(i).dl_set) _dl_remove(i);
+    _HOT(i).dl_set = (_THRD(i).rel_dl != 0);
+    _HOT(i).deadline = release + _THRD(i).rel_dl;
+    if (_HOT(i).dl_set) _dl_insert(i);
+}
+
+/**
+ * Select runnable thread with the nearest absolute deadline as the next one
+ * to run. Threads with equal deadlines are selected in the round-robin order.
+ *
+ * The deadlines list is walked up to the first runnable thread and the
+ * following threads with the same deadline, therefore only threads with a
+ * deadline are scanned (and typically a few of them).
+ *
+ * @return @c true if the thread has been selected (and set as the current
+ *     one), @c false if there is no runnable thread with a deadline.
+ */
+static inline bool _edf_select(void)
+{
+    register unsigned i, sel = (unsigned)-1;
+    register coop_tick_t cur_tick = coop_tick_cb();
+
+    for (i = sched.dl_head; i; i = _HOT(i - 1).dl_next)
+    {
+        if (sel != (unsigned)-1 && _HOT(i - 1).deadline != _HOT(sel).deadline)
+            break;
+
+        if (_thrd_runnable(i - 1, cur_tick) &&
+            (sel == (unsigned)-1 || _RR_DIST(i - 1) < _RR_DIST(sel)))
+        {
+            sel = i - 1;
         }
+    }
+
+    if (sel != (unsigned)-1) {
+        sched.cur_thrd = sel;
+        return true;
+    }
+    return false;
+}
+#endif /* CONFIG_OPT_EDF */
+
+#if CONFIG_OPT_GROUPS
+/**
+ * Check if group @c a is to be served before group @c b. The groups (or their
+ * ancestors being siblings) run ticks relative to their weights are compared.
+ */
+static inline bool _grp_before(const coop_group_t *a, const coop_group_t *b)
+{
+    while (a->depth > b->depth) a = a->parent;
+    while (b->depth > a->depth) b = b->parent;
+    while (a->parent != b->parent) {
+        a = a->parent;
+        b = b->parent;
+    }
+    return (a != b && a->run_ticks * b->weight < b->run_ticks * a->weight);
+}
+
+/**
+ * Check if group @c a is to be served before its sibling group @c b.
+ */
+static inline bool _grp_sibl_before(
+    const coop_group_t *a, const coop_group_t *b)
+{
+    return (a->run_ticks * b->weight < b->run_ticks * a->weight);
+}
+
+/**
+ * Check if a group lies on the most under-budget path of the groups tree,
+ * that is, no group (or its ancestors) is served after a sibling with threads.
+ */
+static inline bool _grp_best(const coop_group_t *grp)
+{
+    for (; grp; grp = grp->parent) {
+        if (_grp_sibl_before(
+            (grp->parent ? grp->parent->sub_min : groups.top_min), grp))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Select runnable thread of the most under-budget group as the next one to
+ * run. Threads of the same group are selected in the round-robin order.
+ *
+ * The most under-budget path of the groups tree is established basing on the
+ * groups threads counts (groups with no threads are not taken into account),
+ * then threads of the groups on the path are scanned for the runnable one
+ * next in the round-robin order. If threads on the path are idle or waiting,
+ * groups of all runnable threads in the pool are compared.
+ *
+ * @return @c true if the thread has been selected (and set as the current
+ *     one), @c false if there is no runnable thread.
+ */
+static inline bool _grp_select(void)
+{
+    register unsigned i, n, sel = (unsigned)-1;
+    register coop_group_t *grp, **min;
+    register coop_tick_t cur_tick = coop_tick_cb();
+
+    groups.top_min = NULL;
+    for (grp = groups.list; grp; grp = grp->next) grp->sub_min = NULL;
+
+    for (grp = &groups.dflt; grp;
+        grp = (grp == &groups.dflt ? groups.list : grp->next))
+    {
+        if (!grp->thrd_n) continue;
+
+        min = (grp->parent ? &grp->parent->sub_min : &groups.top_min);
+        if (!*min || _grp_sibl_before(grp, *min)) *min = grp;
+    }
 
-        min_idle = COOP_MAX_TICK;
-        cur_tick = coop_tick_cb();  /* current tick */
+    for (grp = &groups.dflt; grp;
+        grp = (grp == &groups.dflt ? groups.list : grp->next))
+    {
+        if (!grp->thrd_n || !_grp_best(grp)) continue;
 
-        for (i = 0; i < CONFIG_MAX_THREADS; i++)
-        {
-            if (_IS_IDLE(sched.thrds[i].state)
-# if CONFIG_OPT_WAIT
-                || (_IS_WAIT(sched.thrds[i].state) &&
-                    !sched.thrds[i].wait_flgs.inf)
-# endif
-                )
+        for (i = grp->thrds; i; i = _HOT(i - 1).grp_next) {
+            if (_thrd_runnable(i - 1, cur_tick) &&
+                (sel == (unsigned)-1 || _RR_DIST(i - 1) < _RR_DIST(sel)))
             {
-                register coop_tick_t idle_to = (
-# if CONFIG_OPT_WAIT
-                    !_IS_IDLE(sched.thrds[i].state) ? sched.thrds[i].wait_to :
-# endif
-                    sched.thrds[i].idle_to);
+                sel = i - 1;
+            }
+        }
+    }
 
-                if (COOP_IS_TICK_OVER(cur_tick, idle_to)) {
-                    coop_dbg_log_cb("Thread #%d %s -> RUN (via idle-loop)\n",
-                        i, _state_name(i));
+    if (sel == (unsigned)-1)
+    {
+        for (n = 0, i = sched.cur_thrd; n < _POOL_SIZE(); n++)
+        {
+            i = (i + 1) % _POOL_SIZE();
 
-                    /* idle time passed; the idle-loop will be finished */
-                    sched.thrds[i].state = RUN;
-                    sched.idle_n--;
-                } else
-                if ((idle_to - cur_tick) < min_idle) {
-                    /* calculate nearest wake-up time */
-                    min_idle = (idle_to - cur_tick);
-                }
+            if (_thrd_runnable(i, cur_tick) && (sel == (unsigned)-1 ||
+                _grp_before(_HOT(i).grp, _HOT(sel).grp)))
+            {
+                sel = i;
             }
         }
     }
+
+    if (sel != (unsigned)-1) {
+        sched.cur_thrd = sel;
+        return true;
+    }
+    return false;
 }
-#endif /* CONFIG_OPT_IDLE */
+#endif /* CONFIG_OPT_GROUPS */
+
+#if CONFIG_OPT_STACK_WM
+/**
+ * Get maximum stack usage water-mark of i-th thread.
+ */
+static size_t _stack_wm(unsigned i)
+{
+    size_t stack_sz = _THRD(i).stack_sz;
+    unsigned char *stack = (unsigned char*)_THRD(i).stack;
+    size_t f, f2; /* free space water-marks */
+
+    if (!stack) {
+        /* stack not yet allocated (the thread has not yielded yet) */
+        return 0;
+    }
+
+    /* first check most common type of stack (growing into lower addresses) */
+    for (f = stack_sz; f && stack[f - 1] == STACK_PADD; f--);
+    f = stack_sz - f;
+
+    if (f < sizeof(void*)) {
+        /* whole stack was filled up or the stack grows into higher addresses */
+        for (f2 = 0; f2 < stack_sz && stack[f2] == STACK_PADD; f2++);
+
+        /* assume growing into higher addresses type of stack */
+        if (f2 > f) f = f2;
+    }
+    return (stack_sz - f);
+}
+
+# if CONFIG_OPT_STACK_PROF
+/**
+ * Record stack usage water-mark of i-th thread in the stack-size profile.
+ * Threads are identified by their names or routines (for unnamed threads).
+ * Threads which have not yielded yet have no water-mark; only their stack
+ * sizes are recorded.
+ */
+static void _stack_prof_record(unsigned i)
+{
+    unsigned j;
+    coop_stack_prof_t *rec = NULL;
+    const char *name = _THRD(i).name;
+    size_t wm = _stack_wm(i);
+
+    for (j = 0; j < stack_prof.n; j++) {
+        if (name ? (stack_prof.recs[j].name &&
+                !strcmp(stack_prof.recs[j].name, name)) :
+            (!stack_prof.recs[j].name &&
+                stack_prof.recs[j].proc == _THRD(i).proc))
+        {
+            rec = &stack_prof.recs[j];
+            break;
+        }
+    }
+
+    if (!rec) {
+        if (stack_prof.n >= CONFIG_STACK_PROF_ENTRIES) {
+            coop_dbg_log_cb("Stack profile full; thread #%d not recorded\n", i);
+            return;
+        }
+        rec = &stack_prof.recs[stack_prof.n++];
+        rec->name = name;
+        rec->proc = _THRD(i).proc;
+    }
+
+    if (rec->stack_sz < _THRD(i).stack_sz) rec->stack_sz = _THRD(i).stack_sz;
+    if (!_THRD(i).stack) return;
+
+    if (rec->wm < wm) rec->wm = wm;
+    rec->samples++;
+}
+# endif
+#endif /* CONFIG_OPT_STACK_WM */
+
+#if CONFIG_OPT_SUSPEND
+/**
+ * Clear suspension of the terminating i-th thread (suspended while running).
+ */
+static inline void _susp_clear(unsigned i)
+{
+    if (_HOT(i).state == SUSPENDED) {
+        _HOT(i).state = RUN;
+# if CONFIG_OPT_IDLE
+        sched.idle_n--;
+# endif
+# if CONFIG_OPT_GROUPS
+        _grp_thrd_n(_HOT(i).grp, true);
+# endif
+    }
+}
+#endif
 
 void coop_sched_service(void)
 {
+#if CONFIG_OPT_TIMERS
+    while (sched.busy_n > 0 || sched.timers)
+#else
     while (sched.busy_n > 0)
+#endif
     {
+#if CONFIG_OPT_TIMERS
+        if (sched.timers) _timers_run(coop_tick_cb());
+#endif
+#if CONFIG_OPT_WAIT_DEFER_PREDIC
+        if (_NOTIF_PENDING()) _notify_deferred();
+#endif
 #if CONFIG_OPT_IDLE
         /*
          * The routine is called if currently handled thread passed through
@@ -338,6 +1557,10 @@ void coop_sched_service(void)
          * performance of the scheduler service.
          */
         _system_idle();
+#endif
+#if CONFIG_OPT_TIMERS
+        /* no threads to run; active timers only */
+        if (!sched.busy_n) continue;
 #endif
         /*
          * coop_sched_service() routine is called recursively during building
@@ -345,11 +1568,26 @@ void coop_sched_service(void)
          * occurs the cur_thrd index need to be updated for the next thread to
          * process. For this reason the incrementation takes place at the loop
          * entry stage.
+         *
+         * With EDF policy, runnable thread with the nearest deadline is
+         * dispatched first. Threads with no deadline are dispatched in the
+         * round-robin order if there is no runnable thread with a deadline.
+         *
+         * With threads groups initialized, runnable thread of the most
+         * under-budget group is dispatched (subject to EDF policy).
          */
+#if CONFIG_OPT_EDF
+        if (_edf_select()) goto dispatch;
+#endif
+#if CONFIG_OPT_GROUPS
+        if (groups.list && _grp_select()) goto dispatch;
+#endif
 next_iter:
-        sched.cur_thrd = (sched.cur_thrd + 1) % CONFIG_MAX_THREADS;
-
-        switch (sched.thrds[sched.cur_thrd].state)
+        sched.cur_thrd = (sched.cur_thrd + 1) % _POOL_SIZE();
+#if CONFIG_OPT_EDF || CONFIG_OPT_GROUPS
+dispatch:
+#endif
+        switch (_HOT(sched.cur_thrd).state)
         {
         case EMPTY:
 #if !CONFIG_NOEXIT_STATIC_THREADS
@@ -361,7 +1599,7 @@ next_iter:
 #if CONFIG_OPT_IDLE
         case IDLE:
             if (!COOP_IS_TICK_OVER(
-                    coop_tick_cb(), sched.thrds[sched.cur_thrd].idle_to))
+                    coop_tick_cb(), _HOT(sched.cur_thrd).idle_to))
             {
                 /* the current thread is idle but other threads are running;
                    system can't switch to the idle state in this case */
@@ -371,16 +1609,16 @@ next_iter:
             /* idle time passed; continue as in RUN state  */
             coop_dbg_log_cb("Thread #%d IDLE -> RUN (via sched-loop)\n",
                 sched.cur_thrd);
-            sched.thrds[sched.cur_thrd].state = RUN;
+            _HOT(sched.cur_thrd).state = RUN;
             sched.idle_n--;
             goto run;
 #endif
 
 #if CONFIG_OPT_WAIT
         case WAIT:
-            if (sched.thrds[sched.cur_thrd].wait_flgs.inf ||
+            if (_HOT(sched.cur_thrd).wait_flgs.inf ||
                 !COOP_IS_TICK_OVER(
-                    coop_tick_cb(), sched.thrds[sched.cur_thrd].wait_to))
+                    coop_tick_cb(), _HOT(sched.cur_thrd).wait_to))
             {
                 /* not-notified infinite or not yet timed-out waiting thread */
                 goto next_iter;
@@ -390,7 +1628,7 @@ next_iter:
                 "Thread #%d WAIT -> RUN (timed-out)\n", sched.cur_thrd);
 
             /* wait time passed; continue as in RUN state  */
-            sched.thrds[sched.cur_thrd].state = RUN;
+            _HOT(sched.cur_thrd).state = RUN;
 # if CONFIG_OPT_IDLE
             sched.idle_n--;
 # endif
@@ -407,11 +1645,13 @@ run:
                 coop_dbg_log_cb("setjmp sched_pos_run; run thread #%d: "
                     "longjmp thrd_pos_[new/run]\n", sched.cur_thrd);
 
-#if CONFIG_OPT_YIELD_AFTER
-                sched.thrds[sched.cur_thrd].switch_tick = coop_tick_cb();
+#if _SWITCH_TICK
+                _THRD(sched.cur_thrd).switch_tick = coop_tick_cb();
 #endif
+                _HOOK(switch_in, (sched.cur_thrd));
+
                 /* jump to running thread: thrd_pos_new, thrd_pos_run */
-                longjmp(sched.thrds[sched.cur_thrd].exe_ctx, 1);
+                longjmp(_THRD(sched.cur_thrd).exe_ctx, 1);
             } else {
                 /* return from yielded running thread or restore
                    scheduler stack after thread terminated as a hole */
@@ -424,151 +1664,573 @@ run:
 #if CONFIG_NOEXIT_STATIC_THREADS
             coop_dbg_log_cb("New thread #%d\n", sched.cur_thrd);
 
-# if CONFIG_OPT_YIELD_AFTER
-            sched.thrds[sched.cur_thrd].switch_tick = coop_tick_cb();
+# if _SWITCH_TICK
+            _THRD(sched.cur_thrd).switch_tick = coop_tick_cb();
+# endif
+            _HOOK(spawn, (sched.cur_thrd));
+            _HOOK(switch_in, (sched.cur_thrd));
+
+            /* enter the thread routine */
+            _THRD(sched.cur_thrd).proc(_THRD(sched.cur_thrd).arg);
+# if _SLICE_END
+            _slice_end(sched.cur_thrd);
+# endif
+# if CONFIG_OPT_SUSPEND
+            _susp_clear(sched.cur_thrd);
+# endif
+            _HOOK(terminate, (sched.cur_thrd));
+
+            /* thread configured with CONFIG_NOEXIT_STATIC_THREADS
+               is not expected to finish */
+            coop_dbg_log_cb("UNEXPECTED: Thread #%d: RUN -> EMPTY\n",
+                sched.cur_thrd);
+            _thrd_free(sched.cur_thrd);
+# if CONFIG_OPT_DYN_POOL
+            _pool_shrink();
+# endif
+            break;
+#else
+# if CONFIG_OPT_HOLE_REUSE
+            if (_THRD(sched.cur_thrd).in_hole)
+            {
+                /* sched_pos_run: main-running scheduler execution context */
+                if (!setjmp(sched.exe_ctx))
+                {
+                    coop_dbg_log_cb("setjmp sched_pos_run; new thread #%d in "
+                        "hole: longjmp sched_pos_entry_thrd\n", sched.cur_thrd);
+
+                    /* start the thread in the hole's stack frame;
+                       sched_pos_entry_thrd jump */
+                    longjmp(_THRD(sched.cur_thrd).entry_ctx, _JMP_HOLE_ENTRY);
+                } else {
+                    coop_dbg_log_cb("Back to scheduler from #%d thread\n",
+                        sched.cur_thrd);
+                }
+                break;
+            }
+# endif
+            /* sched_pos_entry_thrd: save a new thread entry stack state */
+            switch (setjmp(_THRD(sched.cur_thrd).entry_ctx))
+            {
+            case 0:
+                coop_dbg_log_cb("setjmp sched_pos_entry_thrd; new thread #%d\n",
+                    sched.cur_thrd);
+
+                sched.depth++;
+                _THRD(sched.cur_thrd).depth = sched.depth;
+# if CONFIG_OPT_HOLE_REUSE
+                _THRD(sched.cur_thrd).entry_sp = _stack_ptr();
+
+                /* fall through */
+            case _JMP_HOLE_ENTRY:
+# endif
+# if _SWITCH_TICK
+                _THRD(sched.cur_thrd).switch_tick = coop_tick_cb();
+# endif
+                _HOOK(spawn, (sched.cur_thrd));
+                _HOOK(switch_in, (sched.cur_thrd));
+
+                /* enter the thread routine */
+# if CONFIG_OPT_CANCEL
+                /* thread canceled before start is terminated at once */
+                if (!_THRD(sched.cur_thrd).cancel)
+# endif
+                _THRD(sched.cur_thrd).proc(_THRD(sched.cur_thrd).arg);
+# if CONFIG_OPT_CANCEL
+
+                /* fall through */
+            case _JMP_CANCEL:
+                /* canceled thread's stack unwound at a cancellation point */
+# endif
+# if _SLICE_END
+                _slice_end(sched.cur_thrd);
+# endif
+# if CONFIG_OPT_EDF
+                _job_end(sched.cur_thrd, coop_tick_cb());
+                if (_HOT(sched.cur_thrd).dl_set) _dl_remove(sched.cur_thrd);
+# endif
+# if CONFIG_OPT_STACK_PROF
+                _stack_prof_record(sched.cur_thrd);
+# endif
+# if CONFIG_OPT_SUSPEND
+                _susp_clear(sched.cur_thrd);
+# endif
+# if CONFIG_OPT_GROUPS
+                _grp_del(sched.cur_thrd);
+# endif
+# if CONFIG_OPT_HOLE_REUSE
+                if (_THRD(sched.cur_thrd).in_hole)
+                    _hole_check(sched.cur_thrd, false);
+# endif
+                _HOOK(terminate, (sched.cur_thrd));
+
+                /*
+                 * At this point the current thread is being terminated.
+                 * Scheduler stack is set at the thread stack frame, therefore
+                 * need to be updated:
+                 *
+                 * - If the terminating thread stack depth is less than the
+                 *   number of threads stacks occupying the main stack, the
+                 *   thread constitutes a hole (a terminated thread with its
+                 *   stack still occupying the main stack space). In this case
+                 *   the scheduler stack frame is restored to its previous
+                 *   position. No stack unwind occurs.
+                 *
+                 * - If the terminating thread stack depth is equal to the
+                 *   number of threads stacks occupying the main stack - the
+                 *   stack unwind occurs. In this case the scheduler stack
+                 *   frame is set to the position of an already terminated
+                 *   thread stack frame (possibly a hole) just above a started
+                 *   thread with most shallow stack.
+                 */
+                if (_THRD(sched.cur_thrd).depth < sched.depth)
+                {
+                    coop_dbg_log_cb("Thread #%d: RUN -> HOLE; "
+                        "scheduler stack-restore: longjmp sched_pos_run\n",
+                        sched.cur_thrd);
+
+                    _HOT(sched.cur_thrd).state = HOLE;
+                    sched.hole_n++;
+# if CONFIG_OPT_HOLE_REUSE
+                    _hole_size(sched.cur_thrd);
+# endif
+                    /* restore previous scheduler stack frame; sched_pos_run jump */
+                    longjmp(sched.exe_ctx, 1);
+                } else
+                {
+                    register unsigned unwnd_thrd = _mark_unwind_thrds();
+
+                    coop_dbg_log_cb("Unwind scheduler stack at #%d thread entry "
+                        "context: longjmp sched_pos_entry_thrd\n", unwnd_thrd);
+
+                    /* unwind scheduler stack; sched_pos_entry_thrd jump */
+                    longjmp(_THRD(unwnd_thrd).entry_ctx, 1);
+                }
+
+            default:
+                /* return with unwinded stack; new scheduler stack frame
+                   from this point */
+                coop_dbg_log_cb("Back to scheduler; stack unwinded\n");
+# if CONFIG_OPT_DYN_POOL
+                _pool_shrink();
+# endif
+                break;
+            }
+            break;
+#endif /* CONFIG_NOEXIT_STATIC_THREADS */
+        }
+    }
+
+#if CONFIG_NOEXIT_STATIC_THREADS
+    /*
+     * Can't exit the routine since stack has not been unwinded
+     * up to its entry point. Assertion will fire in this case.
+     */
+    coop_dbg_log_cb("UNEXPECTED: coop_sched_service() exits!\n");
+    assert(false);
+#else
+    _sched_init(true);
+#endif
+}
+
+coop_error_t coop_sched_thread(coop_thrd_proc_t proc, const char *name,
+    size_t stack_sz, void *arg)
+{
+    coop_thrd_attr_t attr = {0};
+
+    attr.stack_sz = stack_sz;
+    return coop_sched_thread_ex(proc, name, &attr, arg);
+}
+
+coop_error_t coop_sched_thread_ex(coop_thrd_proc_t proc, const char *name,
+    const coop_thrd_attr_t *attr, void *arg)
+{
+    return coop_sched_thread_h(proc, name, attr, arg, NULL);
+}
+
+coop_error_t coop_sched_thread_h(coop_thrd_proc_t proc, const char *name,
+    const coop_thrd_attr_t *attr, void *arg, coop_thrd_t *thrd)
+{
+    unsigned i;
+    size_t stack_sz = (attr ? attr->stack_sz : 0);
+
+    if (!proc) return COOP_ERR_INV_ARG;
+
+    _sched_init(false);
+
+    if (!stack_sz) stack_sz = CONFIG_DEFAULT_STACK_SIZE;
+
+#if CONFIG_OPT_HOLE_REUSE
+    if ((i = _hole_find(stack_sz)) != (unsigned)-1)
+    {
+        /*
+         * The thread is placed in the hole's stack frame. The hole's depth,
+         * size and entry execution context are inherited by the thread.
+         */
+        coop_dbg_log_cb("Thread #%d: HOLE -> NEW (hole size %lu)\n",
+            i, (unsigned long)_THRD(i).hole_sz);
+
+        _THRD(i).in_hole = true;
+        sched.hole_n--;
+    } else
+#endif
+    {
+        if (sched.busy_n >= CONFIG_MAX_THREADS)
+            return COOP_ERR_LIMIT;
+
+#if CONFIG_OPT_DYN_POOL
+        if ((i = _pool_alloc()) == _NO_SLOT)
+            return COOP_ERR_LIMIT;
+#else
+        for (i = 0; i < CONFIG_MAX_THREADS && _HOT(i).state != EMPTY; i++);
+#endif
+#if !CONFIG_NOEXIT_STATIC_THREADS
+        _THRD(i).depth = 0;
+        memset(_THRD(i).entry_ctx, 0, sizeof(_THRD(i).entry_ctx));
+#endif
+#if CONFIG_OPT_HOLE_REUSE
+        _THRD(i).in_hole = false;
+        _THRD(i).hole_sz = 0;
+#endif
+        sched.busy_n++;
+    }
+
+    _THRD(i).proc = proc;
+    _THRD(i).name = name;
+    _THRD(i).stack = NULL;
+    _THRD(i).stack_sz = stack_sz;
+    _THRD(i).arg = arg;
+    _HOT(i).state = NEW;
+    memset(_THRD(i).exe_ctx, 0, sizeof(_THRD(i).exe_ctx));
+#if CONFIG_OPT_WAIT
+    /* a slot of a canceled thread may be left with stale waiting flags */
+    memset(&_HOT(i).wait_flgs, 0, sizeof(_HOT(i).wait_flgs));
+#endif
+#if CONFIG_OPT_QUANTUM
+    _THRD(i).quantum =
+        (attr && attr->quantum ? attr->quantum : CONFIG_DEFAULT_QUANTUM);
+    _THRD(i).overruns = 0;
+#endif
+#if CONFIG_OPT_EDF
+    /* the thread's first job is released at the scheduling time */
+    _THRD(i).rel_dl = (attr ? attr->deadline : 0);
+    _THRD(i).dl_misses = 0;
+    _HOT(i).dl_set = (_THRD(i).rel_dl != 0);
+    _HOT(i).deadline = coop_tick_cb() + _THRD(i).rel_dl;
+    if (_HOT(i).dl_set) _dl_insert(i);
+#endif
+#if CONFIG_OPT_GROUPS
+    _HOT(i).grp = (attr && attr->group ? attr->group : &groups.dflt);
+    _grp_add(i);
+#endif
+
+#if CONFIG_OPT_CANCEL
+    _THRD(i).cancel = false;
+#endif
+#if _THRD_HANDLES
+    /* generation 0 is reserved for invalid handles */
+    if (!++thrd_gen) thrd_gen++;
+    _THRD(i).gen = thrd_gen;
+#endif
+    if (thrd) {
+        thrd->idx = i;
+#if _THRD_HANDLES
+        thrd->gen = _THRD(i).gen;
+#else
+        thrd->gen = 0;
+#endif
+    }
+
+    coop_dbg_log_cb("Thread #%d scheduled to run\n", i);
+
+    return COOP_SUCCESS;
+}
+
+const char *coop_thread_name(void)
+{
+    return _THRD(sched.cur_thrd).name;
+}
+
+#if CONFIG_OPT_SUSPEND || CONFIG_OPT_CANCEL
+/**
+ * Check the thread handle is valid (the thread is not terminated).
+ */
+static bool _thrd_valid(coop_thrd_t thrd)
+{
+    if (!thrd.gen || thrd.idx >= _POOL_SIZE()) return false;
+# if CONFIG_OPT_DYN_POOL
+    if (!sched.chunks[thrd.idx / CONFIG_DYN_POOL_CHUNK]) return false;
+# endif
+    if (_HOT(thrd.idx).state == EMPTY) return false;
+# if !CONFIG_NOEXIT_STATIC_THREADS
+    if (_HOT(thrd.idx).state == HOLE) return false;
+# endif
+    return (_THRD(thrd.idx).gen == thrd.gen);
+}
+#endif
+
+#if _THRD_HANDLES
+coop_thrd_t coop_thread_self(void)
+{
+    coop_thrd_t thrd = {0, 0};
+
+    /* no current thread (e.g. called from main() or ISR); invalid handle */
+    if (sched.cur_thrd >= _POOL_SIZE()) return thrd;
+# if CONFIG_OPT_DYN_POOL
+    if (!sched.chunks[sched.cur_thrd / CONFIG_DYN_POOL_CHUNK]) return thrd;
+# endif
+
+    thrd.idx = sched.cur_thrd;
+    thrd.gen = _THRD(sched.cur_thrd).gen;
+    return thrd;
+}
+#endif
+
+#if CONFIG_OPT_SUSPEND
+coop_error_t coop_suspend(coop_thrd_t thrd, bool freeze)
+{
+    unsigned i = thrd.idx;
+    coop_tick_t to = 0;
+    bool pend = false;
+
+    if (!_thrd_valid(thrd)) return COOP_ERR_INV_ARG;
+    if (_HOT(i).state == SUSPENDED) return COOP_SUCCESS;
+# if CONFIG_OPT_CANCEL
+    /* cancel-pending thread is about to terminate */
+    if (_THRD(i).cancel) return COOP_SUCCESS;
 # endif
-            /* enter the thread routine */
-            sched.thrds[sched.cur_thrd].proc(sched.thrds[sched.cur_thrd].arg);
 
-            /* thread configured with CONFIG_NOEXIT_STATIC_THREADS
-               is not expected to finish */
-            coop_dbg_log_cb("UNEXPECTED: Thread #%d: RUN -> EMPTY\n",
-                sched.cur_thrd);
-            sched.thrds[sched.cur_thrd].state = EMPTY;
-            sched.busy_n--;
-            break;
-#else
-            /* sched_pos_entry_thrd: save a new thread entry stack state */
-            if (!setjmp(sched.thrds[sched.cur_thrd].entry_ctx))
-            {
-                coop_dbg_log_cb("setjmp sched_pos_entry_thrd; new thread #%d\n",
-                    sched.cur_thrd);
+    coop_dbg_log_cb("Thread #%d: %s -> SUSPENDED\n", i, _state_name(i));
 
-                sched.depth++;
-                sched.thrds[sched.cur_thrd].depth = sched.depth;
+# if CONFIG_OPT_IDLE
+    if (_IS_IDLE(_HOT(i).state)) {
+        to = _HOT(i).idle_to;
+        pend = true;
+    }
+# endif
+# if CONFIG_OPT_WAIT
+    if (_IS_WAIT(_HOT(i).state) && !_HOT(i).wait_flgs.inf) {
+        to = _HOT(i).wait_to;
+        pend = true;
+    }
+# endif
+    _THRD(i).susp_frozen = (freeze && pend);
+    if (_THRD(i).susp_frozen) {
+        coop_tick_t cur_tick = coop_tick_cb();
+
+        /* time-out passed: resumed thread is woken-up immediately */
+        _THRD(i).susp_rem =
+            (COOP_IS_TICK_OVER(cur_tick, to) ? 0 : to - cur_tick);
+    }
 
-# if CONFIG_OPT_YIELD_AFTER
-                sched.thrds[sched.cur_thrd].switch_tick = coop_tick_cb();
+# if CONFIG_OPT_IDLE
+    /* idle and waiting threads are already accounted as idle */
+    if (_HOT(i).state == NEW || _HOT(i).state == RUN) sched.idle_n++;
 # endif
-                /* enter the thread routine */
-                sched.thrds[sched.cur_thrd].proc(sched.thrds[sched.cur_thrd].arg);
+# if CONFIG_OPT_GROUPS
+    _grp_thrd_n(_HOT(i).grp, false);
+# endif
+    _THRD(i).susp_state = _HOT(i).state;
+    _HOT(i).state = SUSPENDED;
 
-                /*
-                 * At this point the current thread is being terminated.
-                 * Scheduler stack is set at the thread stack frame, therefore
-                 * need to be updated:
-                 *
-                 * - If the terminating thread stack depth is less than the
-                 *   number of threads stacks occupying the main stack, the
-                 *   thread constitutes a hole (a terminated thread with its
-                 *   stack still occupying the main stack space). In this case
-                 *   the scheduler stack frame is restored to its previous
-                 *   position. No stack unwind occurs.
-                 *
-                 * - If the terminating thread stack depth is equal to the
-                 *   number of threads stacks occupying the main stack - the
-                 *   stack unwind occurs. In this case the scheduler stack
-                 *   frame is set to the position of an already terminated
-                 *   thread stack frame (possibly a hole) just above a started
-                 *   thread with most shallow stack.
-                 */
-                if (sched.thrds[sched.cur_thrd].depth < sched.depth)
-                {
-                    coop_dbg_log_cb("Thread #%d: RUN -> HOLE; "
-                        "scheduler stack-restore: longjmp sched_pos_run\n",
-                        sched.cur_thrd);
+    return COOP_SUCCESS;
+}
 
-                    sched.thrds[sched.cur_thrd].state = HOLE;
-                    sched.hole_n++;
+coop_error_t coop_resume(coop_thrd_t thrd)
+{
+    unsigned i = thrd.idx;
 
-                    /* restore previous scheduler stack frame; sched_pos_run jump */
-                    longjmp(sched.exe_ctx, 1);
-                } else
-                {
-                    register unsigned unwnd_thrd = _mark_unwind_thrds();
+    if (!_thrd_valid(thrd)) return COOP_ERR_INV_ARG;
+    if (_HOT(i).state != SUSPENDED) return COOP_SUCCESS;
 
-                    coop_dbg_log_cb("Unwind scheduler stack at #%d thread entry "
-                        "context: longjmp sched_pos_entry_thrd\n", unwnd_thrd);
+    if (_THRD(i).susp_frozen) {
+        coop_tick_t to = coop_tick_cb() + _THRD(i).susp_rem;
 
-                    /* unwind scheduler stack; sched_pos_entry_thrd jump */
-                    longjmp(sched.thrds[unwnd_thrd].entry_ctx, 1);
-                }
-            } else {
-                /* return with unwinded stack; new scheduler stack frame
-                   from this point */
-                coop_dbg_log_cb("Back to scheduler; stack unwinded\n");
-            }
-            break;
-#endif /* CONFIG_NOEXIT_STATIC_THREADS */
-        }
+# if CONFIG_OPT_IDLE
+        if (_IS_IDLE(_THRD(i).susp_state)) _HOT(i).idle_to = to;
+# endif
+# if CONFIG_OPT_WAIT
+        if (_IS_WAIT(_THRD(i).susp_state)) _HOT(i).wait_to = to;
+# endif
+        (void)to;
     }
 
-#if CONFIG_NOEXIT_STATIC_THREADS
-    /*
-     * Can't exit the routine since stack has not been unwinded
-     * up to its entry point. Assertion will fire in this case.
-     */
-    coop_dbg_log_cb("UNEXPECTED: coop_sched_service() exits!\n");
-    assert(false);
-#else
-    _sched_init(true);
-#endif
+# if CONFIG_OPT_IDLE
+    if (_THRD(i).susp_state == NEW || _THRD(i).susp_state == RUN)
+        sched.idle_n--;
+# endif
+# if CONFIG_OPT_GROUPS
+    _grp_thrd_n(_HOT(i).grp, true);
+# endif
+    _HOT(i).state = _THRD(i).susp_state;
+
+    coop_dbg_log_cb("Thread #%d: SUSPENDED -> %s\n", i, _state_name(i));
+
+    return COOP_SUCCESS;
 }
+#endif /* CONFIG_OPT_SUSPEND */
 
-coop_error_t coop_sched_thread(coop_thrd_proc_t proc, const char *name,
-    size_t stack_sz, void *arg)
+#if CONFIG_OPT_CANCEL
+coop_error_t coop_cancel(coop_thrd_t thrd)
 {
-    if (!proc) {
-        return COOP_ERR_INV_ARG;
-    } else if (sched.busy_n >= CONFIG_MAX_THREADS) {
-        return COOP_ERR_LIMIT;
-    }
+    unsigned i = thrd.idx;
 
-    _sched_init(false);
+    if (!_thrd_valid(thrd)) return COOP_ERR_INV_ARG;
+    if (_THRD(i).cancel) return COOP_SUCCESS;
 
-    for (unsigned i = 0; i < CONFIG_MAX_THREADS; i++) {
-        if (sched.thrds[i].state == EMPTY)
-        {
-            sched.thrds[i].proc = proc;
-            sched.thrds[i].name = name;
-            sched.thrds[i].stack = NULL;
-            sched.thrds[i].stack_sz =
-                (!stack_sz ? CONFIG_DEFAULT_STACK_SIZE : stack_sz);
-            sched.thrds[i].arg = arg;
-            sched.thrds[i].state = NEW;
-#if !CONFIG_NOEXIT_STATIC_THREADS
-            sched.thrds[i].depth = 0;
-            memset(sched.thrds[i].entry_ctx, 0, sizeof(sched.thrds[i].entry_ctx));
-#endif
-            memset(sched.thrds[i].exe_ctx, 0, sizeof(sched.thrds[i].exe_ctx));
+    coop_dbg_log_cb("Thread #%d canceled\n", i);
+    _THRD(i).cancel = true;
 
-            sched.busy_n++;
-            coop_dbg_log_cb("Thread #%d scheduled to run\n", i);
-            break;
-        }
+# if CONFIG_OPT_SUSPEND
+    coop_resume(thrd);
+# endif
+    if (_IS_IDLE(_HOT(i).state) || _IS_WAIT(_HOT(i).state))
+    {
+        /* wake-up the thread to reach its cancellation point */
+# if CONFIG_OPT_WAIT
+        _HOT(i).wait_flgs.notif = 0;
+# endif
+        _HOT(i).state = RUN;
+# if CONFIG_OPT_IDLE
+        sched.idle_n--;
+# endif
     }
     return COOP_SUCCESS;
 }
 
-const char *coop_thread_name(void)
+bool coop_cancel_pending(void)
+{
+    return _THRD(sched.cur_thrd).cancel;
+}
+#endif /* CONFIG_OPT_CANCEL */
+
+#if CONFIG_OPT_HOOKS
+const coop_hooks_t *coop_set_hooks(const coop_hooks_t *new_hooks)
+{
+    const coop_hooks_t *prev = hooks;
+
+    hooks = new_hooks;
+    return prev;
+}
+
+void _coop_hooks_push(const coop_hooks_t *new_hooks, const coop_hooks_t **prev)
+{
+    *prev = hooks;
+    hooks = new_hooks;
+}
+
+coop_error_t _coop_hooks_pop(
+    const coop_hooks_t *cur_hooks, const coop_hooks_t *prev)
+{
+    if (hooks != cur_hooks) return COOP_ERR_LIMIT;
+
+    hooks = prev;
+    return COOP_SUCCESS;
+}
+#endif
+
+#if CONFIG_OPT_CANCEL
+/**
+ * Cancellation point reached by a cancel-pending thread. Unwind the thread's
+ * stack up to its routine entry and terminate the thread.
+ */
+static void _cancel_unwind(void)
+{
+    coop_dbg_log_cb("Thread #%d canceled; unwind thread stack: "
+        "longjmp sched_pos_entry_thrd\n", sched.cur_thrd);
+
+    /* terminate the thread; sched_pos_entry_thrd jump */
+    longjmp(_THRD(sched.cur_thrd).entry_ctx, _JMP_CANCEL);
+}
+#endif
+
+#if CONFIG_OPT_EVGROUPS
+/**
+ * Set state of the yielding thread. Event group waiter, which awaited bits
+ * have been set (e.g. by ISR) after the waiter has been registered, is not
+ * switched to the waiting state. The check is performed in the ISR critical
+ * section, therefore no event group setting is lost.
+ */
+static inline void _yield_state(
+    unsigned char *state, coop_thrd_state_t new_state)
 {
-    return sched.thrds[sched.cur_thrd].name;
+    unsigned isr;
+
+    if (new_state != WAIT || !_HOT(sched.cur_thrd).wait_flgs.evg ||
+        state != &_HOT(sched.cur_thrd).state)
+    {
+        *state = new_state;
+        return;
+    }
+
+    isr = coop_isr_lock_cb();
+    if (_HOT(sched.cur_thrd).wait_flgs.notif) {
+        coop_dbg_log_cb("Thread #%d event group bits already set\n",
+            sched.cur_thrd);
+        new_state = RUN;
+# if CONFIG_OPT_IDLE
+        sched.idle_n--;
+# endif
+    }
+    *state = new_state;
+    coop_isr_unlock_cb(isr);
 }
+#else
+# define _yield_state(state, new_state) (*(state) = (new_state))
+#endif
 
 /**
  * @c new_state specifies a state to set before yielding (RUN, IDLE, WAIT).
  */
 static inline void _yield(coop_thrd_state_t new_state)
 {
-    if (sched.thrds[sched.cur_thrd].state == NEW) {
-        sched.thrds[sched.cur_thrd].state = new_state;
+    unsigned char *state = &_HOT(sched.cur_thrd).state;
+
+#if CONFIG_OPT_CANCEL
+    if (_THRD(sched.cur_thrd).cancel)
+    {
+        /* the caller has already accounted the thread as idle */
+# if CONFIG_OPT_IDLE
+        if (new_state != RUN) sched.idle_n--;
+# endif
+        _cancel_unwind();
+    }
+#endif
+
+#if _SLICE_END
+    _slice_end(sched.cur_thrd);
+#endif
+    _HOOK(switch_out, (sched.cur_thrd));
+
+#if CONFIG_OPT_SUSPEND
+    if (_HOT(sched.cur_thrd).state == SUSPENDED) {
+        /*
+         * The thread has been suspended while running. The new state is
+         * the one the thread will be resumed into. The thread has been
+         * already accounted as idle by the suspension.
+         */
+        state = &_THRD(sched.cur_thrd).susp_state;
+# if CONFIG_OPT_IDLE
+        if (new_state != RUN) sched.idle_n--;
+# endif
+    }
+#endif
+
+    if (*state == NEW) {
+        _yield_state(state, new_state);
 
         /* thrd_pos_new: newly created thread context */
-        if (!setjmp(sched.thrds[sched.cur_thrd].exe_ctx))
+        if (!setjmp(_THRD(sched.cur_thrd).exe_ctx))
         {
             coop_dbg_log_cb("setjmp thrd_pos_new; thread #%d: NEW -> %s\n",
                 sched.cur_thrd, _state_name(sched.cur_thrd));
 
+#if CONFIG_OPT_HOLE_REUSE
+            /* thread placed in a hole must fit in it with its stack */
+            if (_THRD(sched.cur_thrd).in_hole)
+                _hole_check(sched.cur_thrd, true);
+#endif
+
             /* allocate thread stack */
             /*
              * NOTE: For performance reason the allocation takes place after
@@ -590,11 +2252,26 @@ static inline void _yield(coop_thrd_state_t new_state)
              * stack space which is used dynamically by the thread during its
              * lifetime (including preemptive ISRs).
              */
-            sched.thrds[sched.cur_thrd].stack =
-                alloca(sched.thrds[sched.cur_thrd].stack_sz);
-            memset(sched.thrds[sched.cur_thrd].stack, STACK_PADD,
-                sched.thrds[sched.cur_thrd].stack_sz);
+            _THRD(sched.cur_thrd).stack =
+                alloca(_THRD(sched.cur_thrd).stack_sz);
+            memset(_THRD(sched.cur_thrd).stack, STACK_PADD,
+                _THRD(sched.cur_thrd).stack_sz);
+
+#if CONFIG_OPT_HOLE_REUSE
+            if (_THRD(sched.cur_thrd).in_hole)
+            {
+                /*
+                 * Thread placed in a hole has its stack frame already built.
+                 * There is no need to build the next thread stack frame on
+                 * top of it (the space is occupied by the next threads).
+                 */
+                coop_dbg_log_cb("Back from #%d thread (in hole) to scheduler: "
+                    "longjmp sched_pos_run\n", sched.cur_thrd);
 
+                /* back to scheduler: sched_pos_run jump */
+                longjmp(sched.exe_ctx, 1);
+            }
+#endif
             /* build new thread stack via recurrent scheduler service call */
             coop_sched_service();
         } else {
@@ -603,7 +2280,7 @@ static inline void _yield(coop_thrd_state_t new_state)
                 sched.cur_thrd);
         }
     } else {
-        sched.thrds[sched.cur_thrd].state = new_state;
+        _yield_state(state, new_state);
 #if COOP_DEBUG
         if (new_state != RUN) {
             coop_dbg_log_cb("Thread #%d: RUN -> %s\n",
@@ -612,7 +2289,7 @@ static inline void _yield(coop_thrd_state_t new_state)
 #endif
 
         /* thrd_pos_run: main-running thread context */
-        if (!setjmp(sched.thrds[sched.cur_thrd].exe_ctx))
+        if (!setjmp(_THRD(sched.cur_thrd).exe_ctx))
         {
             coop_dbg_log_cb("setjmp thrd_pos_run; back from #%d thread to "
                 "scheduler: longjmp sched_pos_run\n", sched.cur_thrd);
@@ -625,37 +2302,235 @@ static inline void _yield(coop_thrd_state_t new_state)
                 sched.cur_thrd);
         }
     }
+
+#if CONFIG_OPT_CANCEL
+    /* canceled while yielded; wait returns COOP_ERR_CANCELED instead */
+    if (_THRD(sched.cur_thrd).cancel && !_IS_WAIT(new_state))
+        _cancel_unwind();
+#endif
+}
+
+#if CONFIG_OPT_IDLE
+/**
+ * Set the current thread idle up to @c idle_to tick. The thread only yields
+ * if the tick has already been reached.
+ */
+static void _idle_until(coop_tick_t cur_tick, coop_tick_t idle_to)
+{
+    coop_thrd_state_t new_state = RUN;
+
+    if (!COOP_IS_TICK_OVER(cur_tick, idle_to)) {
+        coop_dbg_log_cb("Thread #%d going idle for %lu ticks\n",
+            sched.cur_thrd, (unsigned long)(idle_to - cur_tick));
+
+        new_state = IDLE;
+        sched.idle_n++;
+        _HOT(sched.cur_thrd).idle_to = idle_to;
+    }
+# if CONFIG_OPT_EDF
+    /* current job completes; next one is released at the wake-up time */
+    _job_next(sched.cur_thrd, cur_tick, idle_to);
+# endif
+    _yield(new_state);
+}
+
+void coop_idle(coop_tick_t period)
+{
+    coop_tick_t cur_tick = coop_tick_cb();
+
+    if (period > 0) {
+        _idle_until(cur_tick, cur_tick + period);
+    } else {
+# if CONFIG_OPT_EDF
+        /* current job completes; next one is released immediately */
+        _job_next(sched.cur_thrd, cur_tick, cur_tick);
+# endif
+        _yield(RUN);
+    }
+}
+
+void coop_idle_until(coop_tick_t tick)
+{
+    _idle_until(coop_tick_cb(), tick);
+}
+
+void coop_periodic_init(coop_periodic_t *per, coop_tick_t period)
+{
+    per->period = period;
+    per->next = coop_tick_cb() + period;
+    per->overruns = 0;
+}
+
+unsigned coop_periodic_wait(coop_periodic_t *per, bool skip)
+{
+    coop_tick_t release, cur_tick = coop_tick_cb();
+    unsigned missed = 0;
+
+    if (cur_tick != per->next && COOP_IS_TICK_OVER(cur_tick, per->next))
+    {
+        /* overrun: the next cycle release time has already passed */
+        missed = (unsigned)((cur_tick - per->next - 1) / per->period) + 1;
+        per->overruns++;
+
+        /* if skipped, the cycle is released at the nearest period boundary
+           not in the past; released immediately otherwise */
+        if (skip) per->next += (coop_tick_t)missed * per->period;
+    }
+
+    release = per->next;
+    per->next += per->period;
+    _idle_until(cur_tick, release);
+
+    return missed;
+}
+#else
+void coop_yield(void)
+{
+    _yield(RUN);
+}
+#endif
+
+#if CONFIG_OPT_QUANTUM
+/**
+ * Check if the current thread's quantum has expired.
+ */
+static inline bool _quantum_expired(coop_tick_t cur_tick)
+{
+    return (_THRD(sched.cur_thrd).quantum &&
+        COOP_IS_TICK_OVER(cur_tick, _THRD(sched.cur_thrd).switch_tick +
+            _THRD(sched.cur_thrd).quantum));
+}
+
+void coop_yield_check(void)
+{
+    register coop_tick_t cur_tick = coop_tick_cb();
+
+    if (_quantum_expired(cur_tick)) {
+        coop_dbg_log_cb("Thread #%d quantum expired\n", sched.cur_thrd);
+# if CONFIG_OPT_EDF
+        _job_next(sched.cur_thrd, cur_tick, cur_tick);
+# endif
+        _yield(RUN);
+    }
+}
+
+unsigned coop_thread_overruns(void)
+{
+    return _THRD(sched.cur_thrd).overruns;
+}
+#endif
+
+#if CONFIG_OPT_LONG_SLICE
+coop_long_slice_cb_t coop_set_long_slice_cb(
+    coop_long_slice_cb_t cb, coop_tick_t threshold)
+{
+    coop_long_slice_cb_t prev = long_slice.cb;
+
+    long_slice.cb = cb;
+    long_slice.threshold = (threshold ? threshold : CONFIG_LONG_SLICE_TICKS);
+    return prev;
+}
+#endif
+
+#if CONFIG_OPT_EDF
+void coop_set_deadline(coop_tick_t deadline)
+{
+    _THRD(sched.cur_thrd).rel_dl = deadline;
+}
+
+unsigned coop_thread_dl_misses(void)
+{
+    return _THRD(sched.cur_thrd).dl_misses;
+}
+#endif
+
+#if CONFIG_OPT_GROUPS
+coop_error_t coop_group_init(coop_group_t *grp, const char *name,
+    unsigned weight, coop_group_t *parent)
+{
+    coop_group_t *g;
+
+    if (!grp || !weight) return COOP_ERR_INV_ARG;
+
+    /* re-initialization would corrupt the groups list */
+    for (g = groups.list; g; g = g->next) {
+        if (g == grp) return COOP_ERR_INV_ARG;
+    }
+
+    grp->name = name;
+    grp->parent = parent;
+    grp->depth = (parent ? parent->depth + 1 : 0);
+    grp->weight = weight;
+    grp->run_ticks = grp->total_ticks = 0;
+    grp->thrd_n = grp->thrds = 0;
+    grp->sub_min = NULL;
+
+    grp->next = groups.list;
+    groups.list = grp;
+
+    return COOP_SUCCESS;
+}
+
+coop_tick_t coop_group_run_ticks(const coop_group_t *grp)
+{
+    return grp->total_ticks;
+}
+#endif
+
+#if CONFIG_OPT_LOAD_STATS
+void coop_load_stats(coop_load_stats_t *stats)
+{
+    *stats = load.stats;
 }
 
-#if CONFIG_OPT_IDLE
-void coop_idle(coop_tick_t period)
+void coop_load_stats_reset(void)
 {
-    coop_thrd_state_t new_state = RUN;
-
-    if (period > 0) {
-        coop_dbg_log_cb("Thread #%d going idle for %lu ticks\n",
-            sched.cur_thrd, (unsigned long)period);
-
-        new_state = IDLE;
-        sched.idle_n++;
-        sched.thrds[sched.cur_thrd].idle_to = coop_tick_cb() + period;
-    }
-    _yield(new_state);
+    memset(&load, 0, sizeof(load));
 }
-#else
-void coop_yield(void)
+
+void coop_cpu_load(coop_load_t *cpu_load)
 {
-    _yield(RUN);
+    unsigned i;
+    coop_tick_t cur_tick = coop_tick_cb();
+    coop_tick_t frame = cur_tick / CONFIG_LOAD_BUCKET_TICKS;
+    coop_tick_t idle = 0, run = 0, busy, window;
+
+    /* window ends at the current tick (current bucket is filled partially) */
+    window = _LOAD_WINDOW - CONFIG_LOAD_BUCKET_TICKS +
+        cur_tick % CONFIG_LOAD_BUCKET_TICKS + 1;
+
+    for (i = 0; i < CONFIG_LOAD_WINDOW_BUCKETS; i++) {
+        if (frame - load.buckets[i].frame < CONFIG_LOAD_WINDOW_BUCKETS) {
+            idle += load.buckets[i].idle;
+            run += load.buckets[i].run;
+        }
+    }
+
+    busy = (idle < window ? window - idle : 0);
+    if (run > busy) run = busy;
+
+    cpu_load->busy = (unsigned)((busy * 1000U) / window);
+    cpu_load->thrds = (unsigned)((run * 1000U) / window);
+    cpu_load->sched = cpu_load->busy - cpu_load->thrds;
 }
-#endif
+#endif /* CONFIG_OPT_LOAD_STATS */
 
 #if CONFIG_OPT_YIELD_AFTER
 void coop_yield_after(coop_tick_t *after, coop_tick_t period)
 {
-    if (COOP_IS_TICK_OVER(coop_tick_cb(), *after))
+    register coop_tick_t cur_tick = coop_tick_cb();
+
+    if (COOP_IS_TICK_OVER(cur_tick, *after)
+# if CONFIG_OPT_QUANTUM
+        || _quantum_expired(cur_tick)
+# endif
+        )
     {
         coop_dbg_log_cb("Thread #%d yields after %lu tick\n",
             sched.cur_thrd, (unsigned long)*after);
+# if CONFIG_OPT_EDF
+        _job_next(sched.cur_thrd, cur_tick, cur_tick);
+# endif
 
         _yield(RUN);
         *after = coop_tick_cb() + period;
@@ -664,25 +2539,39 @@ void coop_yield_after(coop_tick_t *after, coop_tick_t period)
 #endif
 
 #if CONFIG_OPT_WAIT
-coop_error_t coop_wait_cond(
-    int sem_id, coop_tick_t timeout, coop_predic_proc_t predic, void *cv)
+/**
+ * Switch current thread into the waiting state with a given timeout.
+ * Waiting related fields (semaphore id(s), predicate) shall be set before the
+ * call.
+ */
+static inline coop_error_t _wait(coop_tick_t timeout)
 {
-    sched.thrds[sched.cur_thrd].sem_id = sem_id;
-    sched.thrds[sched.cur_thrd].predic = predic;
-    sched.thrds[sched.cur_thrd].cv = cv;
-    sched.thrds[sched.cur_thrd].wait_flgs.notif = 0;
+# if CONFIG_OPT_EVGROUPS
+    /* event group waiter may be already notified since its registration */
+    if (!_HOT(sched.cur_thrd).wait_flgs.evg)
+# endif
+    _HOT(sched.cur_thrd).wait_flgs.notif = 0;
+# if CONFIG_OPT_WAIT_DEFER_PREDIC
+    /* notifications already queued don't apply to the thread */
+    _HOT(sched.cur_thrd).wait_flgs.eval = 0;
+    {
+        /* the sequence is shared with the notifying routines */
+        unsigned isr = coop_isr_lock_cb();
+        _THRD(sched.cur_thrd).wait_seq = sched.notif_seq++;
+        coop_isr_unlock_cb(isr);
+    }
+# endif
     if (timeout) {
-        sched.thrds[sched.cur_thrd].wait_to = coop_tick_cb() + timeout;
-        sched.thrds[sched.cur_thrd].wait_flgs.inf = 0;
+        _HOT(sched.cur_thrd).wait_to = coop_tick_cb() + timeout;
+        _HOT(sched.cur_thrd).wait_flgs.inf = 0;
 
-        coop_dbg_log_cb("Thread #%d waiting with timeout %lu ticks; "
-            "sem_id: %d\n", sched.cur_thrd, (unsigned long)timeout, sem_id);
+        coop_dbg_log_cb("Thread #%d waiting with timeout %lu ticks\n",
+            sched.cur_thrd, (unsigned long)timeout);
     } else {
-        sched.thrds[sched.cur_thrd].wait_to = 0;
-        sched.thrds[sched.cur_thrd].wait_flgs.inf = 1;
+        _HOT(sched.cur_thrd).wait_to = 0;
+        _HOT(sched.cur_thrd).wait_flgs.inf = 1;
 
-        coop_dbg_log_cb("Thread #%d waiting infinitely; sem_id: %d\n",
-            sched.cur_thrd, sem_id);
+        coop_dbg_log_cb("Thread #%d waiting infinitely\n", sched.cur_thrd);
     }
 # if CONFIG_OPT_IDLE
     sched.idle_n++;
@@ -690,73 +2579,489 @@ coop_error_t coop_wait_cond(
 
     _yield(WAIT);
 
-    if (sched.thrds[sched.cur_thrd].wait_flgs.notif != 0) {
+# if CONFIG_OPT_CANCEL
+    if (_THRD(sched.cur_thrd).cancel) {
+        coop_dbg_log_cb("Thread #%d wait canceled\n", sched.cur_thrd);
+        return COOP_ERR_CANCELED;
+    }
+# endif
+    if (_HOT(sched.cur_thrd).wait_flgs.notif != 0) {
         coop_dbg_log_cb("Thread #%d notified on sem_id: %d\n",
-            sched.cur_thrd, sem_id);
+            sched.cur_thrd, _HOT(sched.cur_thrd).sem_id);
         return COOP_SUCCESS;
     } else {
-        coop_dbg_log_cb("Thread #%d wait-timeout; sem_id: %d\n",
-            sched.cur_thrd, sem_id);
+        coop_dbg_log_cb("Thread #%d wait-timeout\n", sched.cur_thrd);
         return COOP_ERR_TIMEOUT;
     }
 }
 
-static inline void _notify(int sem_id, bool single)
+coop_error_t coop_wait_cond(
+    int sem_id, coop_tick_t timeout, coop_predic_proc_t predic, void *cv)
+{
+    coop_dbg_log_cb("Thread #%d going to wait on sem_id: %d\n",
+        sched.cur_thrd, sem_id);
+
+    _HOT(sched.cur_thrd).sem_id = sem_id;
+    _HOT(sched.cur_thrd).wait_flgs.any = 0;
+# if CONFIG_OPT_EVGROUPS
+    _HOT(sched.cur_thrd).wait_flgs.evg = 0;
+# endif
+    _THRD(sched.cur_thrd).predic = predic;
+    _THRD(sched.cur_thrd).cv = cv;
+
+    return _wait(timeout);
+}
+
+coop_error_t _coop_timed_wait(int sem_id, unsigned *wait_n,
+    bool (*try_fn)(void *ctx), void *ctx, coop_tick_t timeout)
+{
+    coop_tick_t wait_to = coop_tick_cb() + timeout, cur_tick = 0;
+    coop_error_t ret = COOP_SUCCESS;
+
+    while (!try_fn(ctx))
+    {
+        if (timeout) {
+            cur_tick = coop_tick_cb();
+            if (COOP_IS_TICK_OVER(cur_tick, wait_to)) {
+                ret = COOP_ERR_TIMEOUT;
+                break;
+            }
+        }
+# if CONFIG_OPT_CANCEL
+        /* don't reach the cancellation point with the waiter accounted */
+        if (_THRD(sched.cur_thrd).cancel) {
+            ret = COOP_ERR_CANCELED;
+            break;
+        }
+# endif
+        if (wait_n) (*wait_n)++;
+        ret = coop_wait(sem_id, (timeout ? wait_to - cur_tick : 0));
+        if (wait_n) (*wait_n)--;
+
+        if (ret != COOP_SUCCESS) break;
+    }
+    return ret;
+}
+
+coop_error_t coop_wait_any(
+    const int *sem_ids, unsigned n, coop_tick_t timeout, unsigned *which)
+{
+    coop_error_t ret;
+
+    if (!sem_ids || !n) return COOP_ERR_INV_ARG;
+
+    coop_dbg_log_cb("Thread #%d going to wait on %u sem_ids\n",
+        sched.cur_thrd, n);
+
+    _HOT(sched.cur_thrd).wait_flgs.any = 1;
+# if CONFIG_OPT_EVGROUPS
+    _HOT(sched.cur_thrd).wait_flgs.evg = 0;
+# endif
+    _THRD(sched.cur_thrd).sem_ids = sem_ids;
+    _THRD(sched.cur_thrd).sem_n = n;
+    _THRD(sched.cur_thrd).predic = NULL;
+
+    if ((ret = _wait(timeout)) == COOP_SUCCESS && which)
+    {
+        /* the notifying semaphore id has been stored by _notify() */
+        for (*which = 0; *which < n; (*which)++) {
+            if (sem_ids[*which] == _HOT(sched.cur_thrd).sem_id) break;
+        }
+    }
+    return ret;
+}
+
+/**
+ * Check if waiting thread @c i is waiting on a given semaphore id.
+ */
+static inline bool _sem_match(unsigned i, int sem_id)
+{
+# if CONFIG_OPT_EVGROUPS
+    if (_HOT(i).wait_flgs.evg) return false;
+# endif
+    if (!_HOT(i).wait_flgs.any) return (_HOT(i).sem_id == sem_id);
+
+    for (unsigned k = 0; k < _THRD(i).sem_n; k++) {
+        if (_THRD(i).sem_ids[k] == sem_id) return true;
+    }
+    return false;
+}
+
+# if CONFIG_OPT_WAIT_DEFER_PREDIC
+/**
+ * Wake-up thread(s) waiting on @c sem_id, which started waiting before
+ * deferred notification with sequence number @c seq was sent. Return @c true
+ * if any thread has been woken-up.
+ */
+static inline bool _notify(int sem_id, bool single, unsigned seq)
+# else
+/**
+ * Wake-up thread(s) waiting on @c sem_id. Return @c true if any thread has
+ * been woken-up.
+ */
+static inline bool _notify(int sem_id, bool single)
+# endif
 {
-    for (unsigned i = 0; i < CONFIG_MAX_THREADS; i++) {
-        if (_IS_WAIT(sched.thrds[i].state) &&
-            sched.thrds[i].sem_id == sem_id &&
-            (!sched.thrds[i].predic || sched.thrds[i].predic(sched.thrds[i].cv)))
+    unsigned i;
+    bool woken = false;
+
+    for (i = 0; i < _POOL_SIZE(); i++) {
+        if (_IS_WAIT(_HOT(i).state) &&
+# if CONFIG_OPT_WAIT_DEFER_PREDIC
+            /* wrap-around safe check the wait started before the notify */
+            seq - _THRD(i).wait_seq - 1 < (unsigned)-1 / 2 &&
+# endif
+            _sem_match(i, sem_id) &&
+# if CONFIG_OPT_WAIT_DEFER_PREDIC
+            (!_THRD(i).predic || _predic_get(i)))
+# else
+            (!_THRD(i).predic || _THRD(i).predic(_THRD(i).cv)))
+# endif
         {
             coop_dbg_log_cb("Thread #%d WAIT -> RUN (%s-notify on sem_id: %d)\n",
                 i, (single ? "single" : "all"), sem_id);
 
-            sched.thrds[i].wait_flgs.notif = 1;
-            sched.thrds[i].state = RUN;
+            /* the notifying semaphore id */
+            _HOT(i).sem_id = sem_id;
+            _HOT(i).wait_flgs.notif = 1;
+            _HOT(i).state = RUN;
 # if CONFIG_OPT_IDLE
             sched.idle_n--;
 # endif
+            woken = true;
             if (single) break;
         }
     }
+    return woken;
+}
+
+# if CONFIG_OPT_WAIT_DEFER_PREDIC
+/**
+ * Wake-up threads waiting before the deferred notifications queue overflowed
+ * (with the latest lost notification sequence number @c seq) as if they were
+ * notified-all on their semaphore ids.
+ */
+static void _notify_ovf(unsigned seq)
+{
+    unsigned i;
+
+    for (i = 0; i < _POOL_SIZE(); i++) {
+        if (_IS_WAIT(_HOT(i).state) &&
+            seq - _THRD(i).wait_seq - 1 < (unsigned)-1 / 2 &&
+# if CONFIG_OPT_EVGROUPS
+            !_HOT(i).wait_flgs.evg &&
+# endif
+            (!_THRD(i).predic || _predic_get(i)))
+        {
+            coop_dbg_log_cb("Thread #%d WAIT -> RUN (queue overflow)\n", i);
+
+            /* the (first) awaited semaphore id is reported */
+            if (_HOT(i).wait_flgs.any) _HOT(i).sem_id = _THRD(i).sem_ids[0];
+            _HOT(i).wait_flgs.notif = 1;
+            _HOT(i).state = RUN;
+# if CONFIG_OPT_IDLE
+            sched.idle_n--;
+# endif
+        }
+    }
 }
 
+/**
+ * Queue notification to be processed by the scheduler. Single-notifications
+ * on the same @c sem_id sent in a row are counted in one queue entry. If the
+ * queue is full the overflow is marked for the scheduler to rescan waiting
+ * threads. No user code is called.
+ */
+static void _notify_queue(int sem_id, bool single)
+{
+    unsigned tail, isr;
+
+    isr = coop_isr_lock_cb();
+
+    if (sched.notif_n)
+    {
+        tail = (sched.notif_head + sched.notif_n - 1) % CONFIG_WAIT_DEFER_QUEUE;
+
+        /* no thread started waiting since the latest notification */
+        if (sched.notif_q[tail].sem_id == sem_id &&
+            sched.notif_q[tail].seq + 1 == sched.notif_seq)
+        {
+            /* notify-all subsumes preceding and following single-notifies */
+            if (!single) {
+                sched.notif_q[tail].single_n = 0;
+            } else
+            if (sched.notif_q[tail].single_n) {
+                sched.notif_q[tail].single_n++;
+            }
+            goto finish;
+        }
+    }
+
+    if (sched.notif_n >= CONFIG_WAIT_DEFER_QUEUE) {
+        /* queue full; waiting threads are rescanned by the scheduler */
+        sched.notif_ovf = true;
+        sched.notif_ovf_seq = sched.notif_seq++;
+    } else {
+        tail = (sched.notif_head + sched.notif_n) % CONFIG_WAIT_DEFER_QUEUE;
+        sched.notif_q[tail].sem_id = sem_id;
+        sched.notif_q[tail].single_n = (single ? 1 : 0);
+        sched.notif_q[tail].seq = sched.notif_seq++;
+        sched.notif_n++;
+    }
+
+finish:
+    coop_isr_unlock_cb(isr);
+}
+# endif
+
 void coop_notify(int sem_id)
 {
+# if CONFIG_OPT_WAIT_DEFER_PREDIC
+    _notify_queue(sem_id, true);
+# else
     _notify(sem_id, true);
+# endif
 }
 
 void coop_notify_all(int sem_id)
 {
+# if CONFIG_OPT_WAIT_DEFER_PREDIC
+    _notify_queue(sem_id, false);
+# else
     _notify(sem_id, false);
+# endif
 }
 #endif /* CONFIG_OPT_WAIT */
 
+#if CONFIG_OPT_EVGROUPS
+/**
+ * Check if event bits match awaited bits.
+ */
+static inline bool _evg_match(unsigned bits, unsigned mask, bool all)
+{
+    return (all ? (bits & mask) == mask : (bits & mask) != 0);
+}
+
+coop_error_t coop_evgroup_wait(coop_evgroup_t *grp, unsigned mask, bool all,
+    bool clear, coop_tick_t timeout, unsigned *bits)
+{
+    coop_error_t ret = COOP_SUCCESS;
+    unsigned grp_bits, isr;
+
+    if (!grp || !mask) return COOP_ERR_INV_ARG;
+
+    /*
+     * The bits are checked and the waiter is registered atomically with
+     * respect to coop_evgroup_set() (possibly called by ISR). Bits set after
+     * the registration are detected before the thread is parked.
+     */
+    isr = coop_isr_lock_cb();
+    grp_bits = grp->bits;
+    if (_evg_match(grp_bits, mask, all)) {
+        /* awaited bits already set; no need to wait */
+        if (clear) grp->bits &= ~mask;
+        coop_isr_unlock_cb(isr);
+    } else {
+        _HOT(sched.cur_thrd).wait_flgs.notif = 0;
+        _HOT(sched.cur_thrd).wait_flgs.any = 0;
+        _THRD(sched.cur_thrd).predic = NULL;
+        _THRD(sched.cur_thrd).evg = grp;
+        _THRD(sched.cur_thrd).evg_bits = mask;
+        _THRD(sched.cur_thrd).evg_all = all;
+        _THRD(sched.cur_thrd).evg_clear = clear;
+        _HOT(sched.cur_thrd).wait_flgs.evg = 1;
+        coop_isr_unlock_cb(isr);
+
+        coop_dbg_log_cb("Thread #%d going to wait on event group %p; "
+            "mask: 0x%x\n", sched.cur_thrd, (void*)grp, mask);
+
+        ret = _wait(timeout);
+
+        isr = coop_isr_lock_cb();
+        _HOT(sched.cur_thrd).wait_flgs.evg = 0;
+
+        /* awaited bits set (and possibly cleared) just after the timeout */
+        if (ret == COOP_ERR_TIMEOUT && _HOT(sched.cur_thrd).wait_flgs.notif)
+            ret = COOP_SUCCESS;
+
+        /* bits at the wake-up time are recorded by coop_evgroup_set() */
+        grp_bits =
+            (ret == COOP_SUCCESS ? _THRD(sched.cur_thrd).evg_bits : grp->bits);
+        coop_isr_unlock_cb(isr);
+    }
+
+    if (bits) *bits = grp_bits;
+    return ret;
+}
+
+void coop_evgroup_set(coop_evgroup_t *grp, unsigned bits)
+{
+    unsigned i, clr_bits = 0, isr;
+
+    isr = coop_isr_lock_cb();
+    grp->bits |= bits;
+
+    for (i = 0; i < _POOL_SIZE(); i++)
+    {
+        if (!_HOT(i).wait_flgs.evg ||
+            _HOT(i).wait_flgs.notif ||
+# if CONFIG_OPT_CANCEL
+            _THRD(i).cancel ||
+# endif
+            _THRD(i).evg != grp ||
+            !_evg_match(grp->bits, _THRD(i).evg_bits, _THRD(i).evg_all))
+        {
+            continue;
+        }
+
+        if (_IS_WAIT(_HOT(i).state)) {
+            coop_dbg_log_cb("Thread #%d WAIT -> RUN (event group %p; "
+                "bits: 0x%x)\n", i, (void*)grp, grp->bits);
+
+            _HOT(i).state = RUN;
+# if CONFIG_OPT_IDLE
+            sched.idle_n--;
+# endif
+        } else
+        if (_HOT(i).state != RUN && _HOT(i).state != NEW) {
+            /* suspended waiter is not notified */
+            continue;
+        }
+        /* otherwise registered waiter not parked yet (see _yield_state()) */
+
+        /* awaited bits are cleared after all waiters are processed */
+        if (_THRD(i).evg_clear) clr_bits |= _THRD(i).evg_bits;
+
+        _THRD(i).evg_bits = grp->bits;
+        _HOT(i).wait_flgs.notif = 1;
+    }
+
+    grp->bits &= ~clr_bits;
+    coop_isr_unlock_cb(isr);
+}
+
+void coop_evgroup_clear(coop_evgroup_t *grp, unsigned bits)
+{
+    unsigned isr = coop_isr_lock_cb();
+
+    grp->bits &= ~bits;
+    coop_isr_unlock_cb(isr);
+}
+#endif /* CONFIG_OPT_EVGROUPS */
+
+#if CONFIG_OPT_TIMERS
+coop_error_t coop_timer_start(coop_timer_t *timer, coop_tick_t period,
+    bool periodic, coop_timer_proc_t cb, void *arg)
+{
+    if (!timer || !cb || !period || period > COOP_MAX_PERIOD) {
+        return COOP_ERR_INV_ARG;
+    }
+
+    _sched_init(false);
+
+    if (timer->active) _timer_remove(timer);
+
+    timer->expire = coop_tick_cb() + period;
+    timer->period = period;
+    timer->periodic = periodic;
+    timer->active = true;
+    timer->cb = cb;
+    timer->arg = arg;
+    _timer_insert(timer);
+
+    coop_dbg_log_cb("Timer %p started; period %lu ticks\n",
+        (void*)timer, (unsigned long)period);
+    return COOP_SUCCESS;
+}
+
+void coop_timer_stop(coop_timer_t *timer)
+{
+    if (timer->active) {
+        _timer_remove(timer);
+        timer->active = false;
+    }
+}
+#endif /* CONFIG_OPT_TIMERS */
+
 #if CONFIG_OPT_STACK_WM
 size_t coop_stack_wm()
 {
-    size_t stack_sz = sched.thrds[sched.cur_thrd].stack_sz;
-    unsigned char *stack = (unsigned char*)sched.thrds[sched.cur_thrd].stack;
-    size_t f, f2; /* free space water-marks */
+    return _stack_wm(sched.cur_thrd);
+}
 
-    if (!stack) {
-        /* stack not yet allocated (the routine called before first yield) */
-        return 0;
+# if CONFIG_OPT_STACK_PROF
+void coop_stack_prof_sample(void)
+{
+    unsigned i;
+
+    for (i = 0; i < _POOL_SIZE(); i++) {
+        if (_HOT(i).state == EMPTY) continue;
+#  if !CONFIG_NOEXIT_STATIC_THREADS
+        /* terminated threads are recorded while terminating */
+        if (_HOT(i).state == HOLE) continue;
+#  endif
+        _stack_prof_record(i);
     }
+}
 
-    /* first check most common type of stack (growing into lower addresses) */
-    for (f = stack_sz; f && stack[f - 1] == STACK_PADD; f--);
-    f = stack_sz - f;
+void coop_stack_prof_foreach(coop_stack_prof_cb_t cb, void *arg)
+{
+    unsigned j;
 
-    if (f < sizeof(void*)) {
-        /* whole stack was filled up or the stack grows into higher addresses */
-        for (f2 = 0; f2 < stack_sz && stack[f2] == STACK_PADD; f2++);
+    for (j = 0; j < stack_prof.n; j++) {
+        cb(&stack_prof.recs[j], arg);
+    }
+}
 
-        /* assume growing into higher addresses type of stack */
-        if (f2 > f) f = f2;
+size_t coop_stack_prof_recommend(const coop_stack_prof_t *prof)
+{
+    /* no water-mark recorded; keep the requested size */
+    if (!prof->samples) return prof->stack_sz;
+
+    return (prof->wm + CONFIG_STACK_PROF_MARGIN + 0xfU) & ~(size_t)0xfU;
+}
+
+void coop_stack_prof_dump(coop_stack_prof_print_t print)
+{
+    unsigned j;
+    const char *c;
+    const coop_stack_prof_t *rec;
+
+    print("/* threads stack sizes (water-mark + %u bytes margin) */\n",
+        (unsigned)CONFIG_STACK_PROF_MARGIN);
+
+    for (j = 0; j < stack_prof.n; j++)
+    {
+        rec = &stack_prof.recs[j];
+
+        print("#define COOP_STACK_SZ_");
+        if (rec->name) {
+            for (c = rec->name; *c; c++) {
+                print("%c", ((*c >= 'a' && *c <= 'z') ||
+                    (*c >= 'A' && *c <= 'Z') ||
+                    (*c >= '0' && *c <= '9') ? *c : '_'));
+            }
+        } else {
+            print("proc_%lx", (unsigned long)(uintptr_t)rec->proc);
+        }
+        if (!rec->samples) {
+            print(" 0x%lxU // no data, stack_sz: 0x%lx\n",
+                (unsigned long)coop_stack_prof_recommend(rec),
+                (unsigned long)rec->stack_sz);
+        } else {
+            print(" 0x%lxU // wm: 0x%lx, stack_sz: 0x%lx, samples: %u\n",
+                (unsigned long)coop_stack_prof_recommend(rec),
+                (unsigned long)rec->wm, (unsigned long)rec->stack_sz,
+                rec->samples);
+        }
     }
-    return (stack_sz - f);
 }
+
+void coop_stack_prof_reset(void)
+{
+    memset(&stack_prof, 0, sizeof(stack_prof));
+}
+# endif /* CONFIG_OPT_STACK_PROF */
 #endif /* CONFIG_OPT_STACK_WM */
 
 #ifdef COOP_TEST
@@ -765,7 +3070,7 @@ bool coop_test_is_shallow()
 # if CONFIG_NOEXIT_STATIC_THREADS
     return false;
 # else
-    return (sched.depth == sched.thrds[sched.cur_thrd].depth);
+    return (sched.depth == _THRD(sched.cur_thrd).depth);
 # endif
 }
 
@@ -778,10 +3083,101 @@ void coop_test_set_cur_thrd(unsigned thrd) {
 }
 
 void *coop_test_get_stack(unsigned thrd) {
-    return sched.thrds[thrd].stack;
+    return _THRD(thrd).stack;
 }
 
 void coop_test_set_stack(unsigned thrd, void *stack) {
-    sched.thrds[thrd].stack = stack;
+    _THRD(thrd).stack = stack;
+}
+
+unsigned coop_test_get_pool_size(void) {
+    return _POOL_SIZE();
+}
+
+unsigned coop_test_get_depth(void) {
+# if CONFIG_NOEXIT_STATIC_THREADS
+    return 0;
+# else
+    return sched.depth;
+# endif
+}
+
+const char *coop_test_check_invariants(void)
+{
+    unsigned i, j, busy_n = 0, hole_n = 0, idle_n = 0, max_depth = 0;
+
+    for (i = 0; i < _POOL_SIZE(); i++)
+    {
+        switch (_HOT(i).state)
+        {
+        case EMPTY:
+            continue;
+# if !CONFIG_NOEXIT_STATIC_THREADS
+        case HOLE:
+            hole_n++;
+            break;
+# endif
+        case NEW:
+        case RUN:
+            break;
+# if CONFIG_OPT_IDLE
+        case IDLE:
+            idle_n++;
+            break;
+# endif
+# if CONFIG_OPT_WAIT
+        case WAIT:
+            idle_n++;
+            break;
+# endif
+# if CONFIG_OPT_SUSPEND
+        case SUSPENDED:
+            /* suspended threads are accounted as idle */
+            idle_n++;
+            break;
+# endif
+        default:
+            return "invalid thread state";
+        }
+        busy_n++;
+
+# if !CONFIG_NOEXIT_STATIC_THREADS
+        if (!_THRD(i).depth) continue;
+
+        if (_THRD(i).depth > sched.depth) {
+            return "thread depth exceeds the scheduler depth";
+        }
+        if (_HOT(i).state != HOLE && max_depth < _THRD(i).depth) {
+            max_depth = _THRD(i).depth;
+        }
+
+        /* threads stacks occupy distinct positions on the main stack */
+        for (j = 0; j < i; j++) {
+            if (_HOT(j).state != EMPTY && _THRD(j).depth == _THRD(i).depth)
+                return "threads with the same depth";
+        }
+# endif
+    }
+
+    if (busy_n != sched.busy_n) return "busy_n inconsistent";
+    if (busy_n > CONFIG_MAX_THREADS) return "busy_n exceeds the limit";
+# if !CONFIG_NOEXIT_STATIC_THREADS
+    if (hole_n != sched.hole_n) return "hole_n inconsistent";
+
+    /* the most shallow stack belongs to a not terminated thread */
+    if (max_depth != sched.depth) return "depth inconsistent";
+# endif
+# if CONFIG_OPT_IDLE
+    if (idle_n != sched.idle_n) return "idle_n inconsistent";
+# endif
+# if CONFIG_OPT_DYN_POOL
+    for (i = busy_n = 0; i < sched.chunks_n; i++) {
+        busy_n += sched.chunks[i]->busy_n;
+    }
+    if (busy_n != sched.busy_n) return "chunks busy_n inconsistent";
+# endif
+    (void)j; (void)hole_n; (void)idle_n; (void)max_depth;
+
+    return NULL;
 }
 #endif
@@ -26,7 +26,8 @@ typedef enum
     COOP_SUCCESS = 0,   /** No error. */
     COOP_ERR_INV_ARG,   /** Invalid argument error */
     COOP_ERR_LIMIT,     /** Max. limit reached error */
-    COOP_ERR_TIMEOUT    /** Timeout occured */
+    COOP_ERR_TIMEOUT,   /** Timeout occured */
+    COOP_ERR_CANCELED   /** Thread canceled */
 } coop_error_t;
 
 /**
@@ -46,6 +47,11 @@ typedef void (*coop_thrd_proc_t)(void *arg);
  * @return true Waiting-for-criteria are met and waiting thread(s) shall
  *     be notified (switched back from waiting to running state).
  * @return false Otherwise.
+ *
+ * @note By default the predicate is evaluated by the notifying routine (see
+ *     @ref coop_notify()), therefore may be called from an ISR context. If
+ *     @c CONFIG_OPT_WAIT_DEFER_PREDIC is configured the predicate is evaluated
+ *     by the scheduler only, once per distinct (predicate, @c cv) pair.
  */
 typedef bool (*coop_predic_proc_t)(void *cv);
 #endif
@@ -78,7 +84,8 @@ typedef unsigned long coop_tick_t;
 
 /**
  * Start scheduler service to run scheduled threads.
- * The routine returns when the last scheduled thread ends.
+ * The routine returns when the last scheduled thread ends (and no timers are
+ * active if @c CONFIG_OPT_TIMERS is configured).
  *
  * @note If the library is configured with @ref CONFIG_NOEXIT_STATIC_THREADS
  *     the routine is not intended to exit. @c coop_sched_service() fires
@@ -99,11 +106,133 @@ void coop_sched_service(void);
  *
  * @return COOP_SUCCESS Function finished with success.
  * @return COOP_ERR_INV_ARG Invalid argument.
- * @return COOP_ERR_LIMIT Maximum number of threads reached.
+ * @return COOP_ERR_LIMIT Maximum number of threads reached (or no memory
+ *     available to extend the pool if @c CONFIG_OPT_DYN_POOL is configured).
+ *
+ * @note If @c CONFIG_OPT_HOLE_REUSE is configured, the thread may be placed
+ *     in a hole left by already terminated thread, if its stack fits in the
+ *     hole. The thread takes over the hole's slot on the threads pool in this
+ *     case.
+ *
+ * @note IMPORTANT: A thread placed in a hole builds its stack frames from the
+ *     thread routine entry up to its first yield (the routine's main-scope
+ *     local variables and the library's routines called to yield) inside the
+ *     hole. Contrary to threads placed on top of the main stack, these frames
+ *     are not free of charge: they must fit in @c CONFIG_HOLE_REUSE_MARGIN.
+ *     Threads with large main-scope locals shall not be scheduled with the
+ *     option configured, or the margin shall be increased accordingly. Hole
+ *     overflow is checked (by a canary placed at the hole's end) on the
+ *     thread's first yield and its termination; overflow fires an assertion.
  */
 coop_error_t coop_sched_thread(coop_thrd_proc_t proc, const char *name,
     size_t stack_sz, void *arg);
 
+#if CONFIG_OPT_GROUPS
+/**
+ * Threads group. Threads groups form a hierarchy; CPU time is shared between
+ * sibling groups (and their sub-groups) according to their weights.
+ *
+ * @note The structure is to be treated as opaque and accessed by the threads
+ *     groups API only.
+ */
+typedef struct coop_group
+{
+    /** Group name (may be NULL). */
+    const char *name;
+
+    /** Parent group (NULL for a top-level group) and the group depth. */
+    struct coop_group *parent;
+    unsigned depth;
+
+    /** CPU share weight relative to the sibling groups. */
+    unsigned weight;
+
+    /** Run ticks of the group (including its sub-groups) in the current
+        accounting round and in total. */
+    coop_tick_t run_ticks;
+    coop_tick_t total_ticks;
+
+    /** Number of the group's threads including its sub-groups (terminated
+        and suspended threads not included). */
+    unsigned thrd_n;
+
+    /** Most under-budget sub-group with threads. */
+    struct coop_group *sub_min;
+
+    /** Group's own threads list (internal). */
+    unsigned thrds;
+
+    /** Next group on the groups list. */
+    struct coop_group *next;
+} coop_group_t;
+#endif
+
+/**
+ * Thread attributes.
+ */
+typedef struct
+{
+    /** Thread stack size. If 0 default value configured by
+        @c CONFIG_DEFAULT_STACK_SIZE is used. */
+    size_t stack_sz;
+#if CONFIG_OPT_QUANTUM
+    /** Thread time-slice quantum in ticks. If 0 default value configured by
+        @c CONFIG_DEFAULT_QUANTUM is used. @see coop_yield_check() */
+    coop_tick_t quantum;
+#endif
+#if CONFIG_OPT_EDF
+    /** Relative deadline of the thread's jobs in ticks. If 0 the thread has
+        no deadline. @see coop_set_deadline() */
+    coop_tick_t deadline;
+#endif
+#if CONFIG_OPT_GROUPS
+    /** Group the thread belongs to. If NULL the thread belongs to the default
+        top-level group of weight 1. @see coop_group_init() */
+    coop_group_t *group;
+#endif
+} coop_thrd_attr_t;
+
+/**
+ * Thread handle.
+ *
+ * Handle of a terminated thread becomes invalid, even if the thread's slot in
+ * the threads pool is reused by another thread (the handle's generation
+ * doesn't match in this case). Zeroed handle is always invalid.
+ */
+typedef struct
+{
+    /** Thread slot index in the threads pool. */
+    unsigned idx;
+
+    /** Thread slot generation. */
+    unsigned gen;
+} coop_thrd_t;
+
+/**
+ * Schedule a thread to run with extended thread attributes.
+ *
+ * @param attr Thread attributes. May be @c NULL for default attributes.
+ *     Attributes not set explicitly shall be zeroed.
+ *
+ * @see coop_sched_thread() for other arguments, returned values and notes.
+ */
+coop_error_t coop_sched_thread_ex(coop_thrd_proc_t proc, const char *name,
+    const coop_thrd_attr_t *attr, void *arg);
+
+/**
+ * Schedule a thread to run with extended thread attributes and get its
+ * handle.
+ *
+ * @param thrd If not @c NULL, handle of the scheduled thread is written
+ *     there. The handle is valid only if the library is configured with
+ *     a feature operating on threads handles (@c CONFIG_OPT_SUSPEND,
+ *     @c CONFIG_OPT_CANCEL, @c CONFIG_OPT_MEMPOOL_OWNER).
+ *
+ * @see coop_sched_thread_ex() for other arguments, returned values and notes.
+ */
+coop_error_t coop_sched_thread_h(coop_thrd_proc_t proc, const char *name,
+    const coop_thrd_attr_t *attr, void *arg, coop_thrd_t *thrd);
+
 /**
  * Get currently running thread name (as passed to @ref coop_sched_thread()
  * during thread creation).
@@ -112,6 +241,95 @@ coop_error_t coop_sched_thread(coop_thrd_proc_t proc, const char *name,
  */
 const char *coop_thread_name(void);
 
+#if CONFIG_OPT_SUSPEND || CONFIG_OPT_CANCEL || CONFIG_OPT_MEMPOOL_OWNER
+/**
+ * Get handle of the current thread.
+ *
+ * @note If called outside of a thread (e.g. from @c main() before or after
+ *     the scheduler run) invalid (zeroed) handle is returned.
+ */
+coop_thrd_t coop_thread_self(void);
+#endif
+
+#if CONFIG_OPT_SUSPEND
+/**
+ * Suspend a thread. Suspended thread is not dispatched by the scheduler
+ * until resumed by @ref coop_resume(). Suspended threads are considered idle
+ * while checking whether the system may go idle and they never wake the
+ * system up.
+ *
+ * Pending idle or waiting time-out of the suspended thread may be kept (the
+ * time-out may pass while suspended; the thread is woken-up immediately after
+ * resume in this case) or frozen (the remaining time is restored on resume).
+ * A suspended waiting thread doesn't receive notifications; the waiting
+ * continues after resume.
+ *
+ * If the thread to suspend is the current thread, the suspension takes effect
+ * at the thread's next yield point (e.g. @ref coop_yield()).
+ *
+ * @param thrd Thread handle.
+ * @param freeze Freeze pending idle or waiting time-out.
+ *
+ * @return COOP_SUCCESS Function finished with success (also if the thread has
+ *     already been suspended).
+ * @return COOP_ERR_INV_ARG Invalid (e.g. terminated) thread handle.
+ *
+ * @note To be called from an arbitrary routine including ISR.
+ *
+ * @note While calling from ISR debug logs must be disabled or handled in
+ *     a special way (see @ref CONFIG_DBG_LOG_CB_ALT) to avoid interrupt
+ *     service related issues.
+ */
+coop_error_t coop_suspend(coop_thrd_t thrd, bool freeze);
+
+/**
+ * Resume a thread suspended by @ref coop_suspend().
+ *
+ * @return COOP_SUCCESS Function finished with success (also if the thread has
+ *     not been suspended).
+ * @return COOP_ERR_INV_ARG Invalid (e.g. terminated) thread handle.
+ *
+ * @note To be called from an arbitrary routine including ISR.
+ * @see coop_suspend() for additional notes.
+ */
+coop_error_t coop_resume(coop_thrd_t thrd);
+#endif
+
+#if CONFIG_OPT_CANCEL
+/**
+ * Cancel a thread. The thread is marked as cancel-pending and terminated at
+ * its next cancellation point - any library routine yielding the thread
+ * (e.g. @ref coop_yield(), @ref coop_idle(), @ref coop_wait()). The thread
+ * doesn't return from the routine in this case; its stack is unwound up to
+ * the thread routine entry and the thread is terminated as if the routine
+ * returned.
+ *
+ * The canceled thread which is currently idle is woken-up. Waiting thread is
+ * woken-up and the wait routine returns @ref COOP_ERR_CANCELED, allowing the
+ * thread to release its resources before reaching a cancellation point.
+ * Suspended thread (@c CONFIG_OPT_SUSPEND) is resumed. Not yet started
+ * thread is terminated without being started.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid (e.g. terminated) thread handle.
+ *
+ * @note No destructors or clean-up handlers are run while unwinding the
+ *     thread's stack. Resources held by the thread (e.g. heap memory) shall be
+ *     released before cancellation points reached by a cancel-pending thread
+ *     (see @ref coop_cancel_pending()).
+ *
+ * @note To be called from an arbitrary routine including ISR.
+ */
+coop_error_t coop_cancel(coop_thrd_t thrd);
+
+/**
+ * Check if the current thread is cancel-pending.
+ *
+ * @note To be called from the thread routine only.
+ */
+bool coop_cancel_pending(void);
+#endif
+
 #if CONFIG_OPT_IDLE
 /**
  * Declare the currently running thread shall be idle for specific @c period
@@ -132,6 +350,58 @@ const char *coop_thread_name(void);
  *       may be helpful in this case.
  */
 void coop_idle(coop_tick_t period);
+
+/**
+ * Declare the currently running thread shall be idle up to an absolute clock
+ * @c tick. If the tick has already been reached, the routine acts as
+ * @ref coop_yield(). Contrary to @ref coop_idle(), the wake-up time doesn't
+ * depend on the time of the call, therefore may be used to avoid drift of
+ * periodically executed actions (see also @ref coop_periodic_wait()).
+ *
+ * @note The @c tick argument must not be further than @ref COOP_MAX_PERIOD
+ *     ticks ahead of the current tick.
+ *
+ * @note To be called from the thread routine only.
+ */
+void coop_idle_until(coop_tick_t tick);
+
+/**
+ * Drift-free periodic execution context.
+ */
+typedef struct
+{
+    /** Release time of the next cycle. */
+    coop_tick_t next;
+
+    /** Cycle period. */
+    coop_tick_t period;
+
+    /** Number of overrun cycles (finished after the next cycle release). */
+    unsigned overruns;
+} coop_periodic_t;
+
+/**
+ * Initialize periodic execution context. The first cycle is released
+ * @c period ticks after the call. The @c period must be greater than 0.
+ */
+void coop_periodic_init(coop_periodic_t *per, coop_tick_t period);
+
+/**
+ * Finish the current cycle and wait for the next cycle release. Release times
+ * are advanced by exactly one period each cycle, regardless of the cycle
+ * execution time and scheduling delays.
+ *
+ * @param per Periodic execution context.
+ * @param skip If the cycle has overrun (the next release time has already
+ *     passed), skip missed releases and wait for the nearest period boundary.
+ *     If @c false, the next cycle is released immediately (catch-up).
+ *
+ * @return Number of release times missed by the overrun (0 if the cycle
+ *     finished on time).
+ *
+ * @note To be called from the thread routine only.
+ */
+unsigned coop_periodic_wait(coop_periodic_t *per, bool skip);
 #endif
 
 #if CONFIG_OPT_YIELD_AFTER
@@ -172,6 +442,191 @@ void coop_idle(coop_tick_t period);
 void coop_yield_after(coop_tick_t *after, coop_tick_t period);
 #endif
 
+#if CONFIG_OPT_QUANTUM
+/**
+ * Yield currently running thread back to the scheduler if the thread's
+ * time-slice quantum (see @ref coop_thrd_attr_t) has expired. The quantum is
+ * measured since the time the thread has been switched to by the scheduler.
+ *
+ * @note To be called from the thread routine only.
+ *
+ * @note The routine is intended to be called periodically in time-consuming
+ *     loops, similarly to @ref coop_yield_after() but with no need to track
+ *     the yielding time by the thread. If @c CONFIG_OPT_YIELD_AFTER is
+ *     configured, @ref coop_yield_after() also yields on the quantum
+ *     expiration.
+ */
+void coop_yield_check(void);
+
+/**
+ * Get number of the current thread's time-slices exceeding the thread's
+ * quantum (quantum overruns).
+ *
+ * @note To be called from the thread routine only.
+ */
+unsigned coop_thread_overruns(void);
+#endif
+
+#if CONFIG_OPT_LONG_SLICE
+/**
+ * Long time-slice callback.
+ *
+ * @param name Name of the thread which ran too long (may be @c NULL).
+ * @param slice The thread's time-slice length in ticks.
+ */
+typedef void (*coop_long_slice_cb_t)(const char *name, coop_tick_t slice);
+
+/**
+ * Set long time-slices detector callback. The scheduler measures each
+ * thread's time-slice (since the thread has been switched to until it yields
+ * or terminates) and calls the callback for time-slices longer than the
+ * threshold.
+ *
+ * @param cb Callback to set. @c NULL disables the detector.
+ * @param threshold Time-slice threshold in ticks. If 0 default value
+ *     configured by @c CONFIG_LONG_SLICE_TICKS is used.
+ *
+ * @return Previously set callback.
+ *
+ * @note The callback is called on the yielding thread's stack, therefore
+ *     shall be short and use little stack space.
+ *
+ * @note Since the time-slice is measured while the thread returns to the
+ *     scheduler, a thread which never yields is not reported. See
+ *     @ref coop_wdog_start() for the Unix platform watchdog catching such
+ *     threads.
+ */
+coop_long_slice_cb_t coop_set_long_slice_cb(
+    coop_long_slice_cb_t cb, coop_tick_t threshold);
+#endif
+
+#if CONFIG_OPT_EDF
+/**
+ * Set relative deadline of the current thread's jobs. The deadline applies
+ * starting from the thread's next job.
+ *
+ * With EDF (earliest deadline first) policy the scheduler always dispatches
+ * runnable thread with the nearest absolute deadline. The thread's first job
+ * is released at the time the thread is scheduled (see
+ * @ref coop_sched_thread_ex()). The job completes each time the thread yields
+ * to the scheduler by @ref coop_yield(), @ref coop_idle() (and other idle
+ * routines), @ref coop_yield_after() or @ref coop_yield_check(), and while the
+ * thread terminates. The next job is released at the wake-up time for idle
+ * routines, and immediately otherwise, so a yielding thread doesn't keep its
+ * old deadline. The job's absolute deadline is its release time plus the
+ * relative deadline. Waiting (@ref coop_wait()) doesn't complete the job.
+ * Threads with no deadline are run only if no thread with a deadline is ready
+ * to run.
+ *
+ * @param deadline Relative deadline in ticks. If 0 the thread has no deadline.
+ *
+ * @note To be called from the thread routine only.
+ */
+void coop_set_deadline(coop_tick_t deadline);
+
+/**
+ * Get number of the current thread's jobs completed after their deadlines
+ * (deadline misses).
+ *
+ * @note To be called from the thread routine only.
+ */
+unsigned coop_thread_dl_misses(void);
+#endif
+
+#if CONFIG_OPT_GROUPS
+/**
+ * Initialize threads group. Threads are assigned to the group via
+ * @ref coop_thrd_attr_t while scheduled.
+ *
+ * The scheduler accounts run ticks of the groups threads to the groups (and
+ * their ancestors) and dispatches runnable threads of under-budget groups
+ * first. A group is under-budget if its run ticks relative to its weight are
+ * lower than of its sibling groups. Threads of the default group (not assigned
+ * to any group) compete as a top-level group of weight 1. Threads of the same
+ * group are dispatched in the round-robin order. The groups run ticks are
+ * reset every @c CONFIG_GROUPS_ROUND_TICKS ticks.
+ *
+ * @param grp Group to initialize. The structure shall be maintained by
+ *     a caller for the library lifetime and initialized only once.
+ * @param name Group name. May be @c NULL.
+ * @param weight Group CPU share weight relative to its sibling groups.
+ * @param parent Parent group. If @c NULL the group is a top-level group.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument or the group has been already
+ *     initialized.
+ */
+coop_error_t coop_group_init(coop_group_t *grp, const char *name,
+    unsigned weight, coop_group_t *parent);
+
+/**
+ * Get total run ticks of a group (including its sub-groups).
+ */
+coop_tick_t coop_group_run_ticks(const coop_group_t *grp);
+#endif
+
+#if CONFIG_OPT_LOAD_STATS
+/**
+ * Cumulative system load statistics.
+ */
+typedef struct
+{
+    /** Number of system idle state entries (@ref coop_idle_cb() calls). */
+    unsigned long idle_n;
+
+    /** Number of infinite idle state entries. */
+    unsigned long idle_inf_n;
+
+    /** Total number of ticks spent in the idle state. */
+    coop_tick_t idle_ticks;
+
+    /** Requested and actual number of ticks spent in the idle state for
+        finite idle state entries. */
+    coop_tick_t idle_req_ticks;
+    coop_tick_t idle_fin_ticks;
+
+    /** Total number of ticks spent by running threads. */
+    coop_tick_t run_ticks;
+} coop_load_stats_t;
+
+/**
+ * CPU load over the sliding-window (see @ref CONFIG_LOAD_WINDOW_BUCKETS,
+ * @ref CONFIG_LOAD_BUCKET_TICKS). The values are expressed in permille of the
+ * window span.
+ */
+typedef struct
+{
+    /** Busy (non idle) time. */
+    unsigned busy;
+
+    /** Time spent by running threads. */
+    unsigned thrds;
+
+    /** Scheduler overhead: busy time not spent by running threads. */
+    unsigned sched;
+} coop_load_t;
+
+/**
+ * Get cumulative system load statistics.
+ *
+ * @note The statistics are not reset on the scheduler exit.
+ */
+void coop_load_stats(coop_load_stats_t *stats);
+
+/**
+ * Reset system load statistics and the CPU load sliding-window.
+ */
+void coop_load_stats_reset(void);
+
+/**
+ * Get CPU load over the sliding-window ending at the current tick.
+ *
+ * @note Time passed outside of the scheduler service (e.g. before the
+ *     scheduler has been started) is accounted as the scheduler overhead.
+ */
+void coop_cpu_load(coop_load_t *cpu_load);
+#endif /* CONFIG_OPT_LOAD_STATS */
+
 #if CONFIG_OPT_IDLE
 /**
  * coop_yield() is an alias to coop_idle(0).
@@ -190,7 +645,8 @@ void coop_yield(void);
  * Platform specific callbacks specification section.
  */
 
-#if CONFIG_OPT_IDLE || CONFIG_OPT_YIELD_AFTER || CONFIG_OPT_WAIT
+#if CONFIG_OPT_IDLE || CONFIG_OPT_YIELD_AFTER || CONFIG_OPT_WAIT || \
+    CONFIG_OPT_QUANTUM || CONFIG_OPT_GROUPS || CONFIG_OPT_LONG_SLICE
 /**
  * Get clock tick at the moment of the callback-routine call.
  */
@@ -212,6 +668,25 @@ coop_tick_t coop_tick_cb();
 void coop_idle_cb(coop_tick_t period);
 #endif
 
+#if CONFIG_OPT_WAIT_DEFER_PREDIC || CONFIG_OPT_EVGROUPS
+/**
+ * Enter a critical section protecting the library state shared with ISRs
+ * (e.g. by masking interrupts). The critical sections are short and don't
+ * call any user code.
+ *
+ * @return State to be restored by @ref coop_isr_unlock_cb(). Nested critical
+ *     sections shall be supported.
+ */
+unsigned coop_isr_lock_cb(void);
+
+/**
+ * Leave a critical section entered by @ref coop_isr_lock_cb().
+ *
+ * @param state State returned by the corresponding @ref coop_isr_lock_cb().
+ */
+void coop_isr_unlock_cb(unsigned state);
+#endif
+
 #if CONFIG_OPT_WAIT
 /**
  * Switch current thread into wait-for-a-notification-signal state.
@@ -223,6 +698,7 @@ void coop_idle_cb(coop_tick_t period);
  *
  * @return COOP_SUCCESS Notification signal received
  * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL).
  *
  * @note To be called from the thread routine only.
  *
@@ -254,6 +730,7 @@ void coop_idle_cb(coop_tick_t period);
  *
  * @return COOP_SUCCESS Notification signal received
  * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL).
  *
  * @note To be called from the thread routine only.
  * @see coop_wait() for additional notes.
@@ -261,6 +738,28 @@ void coop_idle_cb(coop_tick_t period);
 coop_error_t coop_wait_cond(
     int sem_id, coop_tick_t timeout, coop_predic_proc_t predic, void *cv);
 
+/**
+ * Wait on multiple semaphore ids at once. The thread is notified by a
+ * notification signal sent on any of the ids.
+ *
+ * @param sem_ids Array of semaphore ids. The array must stay valid for the
+ *     time of waiting.
+ * @param n Number of semaphore ids in @c sem_ids.
+ * @param timeout Waiting timeout. Pass 0 for infinite wait.
+ * @param which If not @c NULL and the thread has been notified, index of the
+ *     notifying semaphore id in @c sem_ids is written under the address.
+ *
+ * @return COOP_SUCCESS Notification signal received
+ * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL).
+ * @return COOP_ERR_INV_ARG Invalid argument(s).
+ *
+ * @note To be called from the thread routine only.
+ * @see coop_wait() for additional notes.
+ */
+coop_error_t coop_wait_any(
+    const int *sem_ids, unsigned n, coop_tick_t timeout, unsigned *which);
+
 /**
  * Send notification signal for a single thread waiting on @c sem_id.
  *
@@ -270,6 +769,15 @@ coop_error_t coop_wait_cond(
  *     a special way (see @ref CONFIG_DBG_LOG_CB_ALT) to avoid interrupt
  *     service related issues.
  *
+ * @note If @c CONFIG_OPT_WAIT_DEFER_PREDIC is configured, the notification is
+ *     only queued (in O(1) time) and processed by the scheduler before
+ *     dispatching next thread, so no user code is run by the notifying
+ *     routine. Queued notifications are processed in order with the same
+ *     effect as immediate ones: each single-notify wakes-up one waiter, and
+ *     threads which started waiting after the notification are not affected.
+ *     Waiting-predicates (see @ref coop_wait_cond()) are evaluated by the
+ *     scheduler. See @c CONFIG_WAIT_DEFER_QUEUE for the queue overflow.
+ *
  * @see coop_wait()
  */
 void coop_notify(int sem_id);
@@ -282,20 +790,1064 @@ void coop_notify(int sem_id);
 void coop_notify_all(int sem_id);
 #endif /* CONFIG_OPT_WAIT */
 
-#if CONFIG_OPT_STACK_WM
+#if CONFIG_OPT_TIMERS
 /**
- * Get maximum stack usage water-mark for the current thread.
+ * Timer callback routine type.
  *
- * @return Max stack usage water-mark in bytes.
+ * @param arg User argument passed untouched to the callback.
+ */
+typedef void (*coop_timer_proc_t)(void *arg);
+
+/**
+ * Timer. The callback is run directly by the scheduler (with no thread's
+ * context) when the timer expires.
  *
- * @note The routine tries to detect type of the platform stack (growing into
- *     lower or higher addresses). Note the algorithm may not to be always
- *     perfectly accurate therefore the returned value shall be treated merely
- *     as an indicator while experimenting with various stack sizes.
+ * @note The structure is to be treated as opaque and accessed by the timers
+ *     API only. Shall be zero initialized before its first use.
+ */
+typedef struct coop_timer
+{
+    /** Next active timer. */
+    struct coop_timer *next;
+
+    /** Expiration tick and the timer period. */
+    coop_tick_t expire;
+    coop_tick_t period;
+
+    /** Periodic timer. */
+    bool periodic;
+
+    /** Active timer. */
+    bool active;
+
+    /** Timer callback and its argument. */
+    coop_timer_proc_t cb;
+    void *arg;
+} coop_timer_t;
+
+/**
+ * Start (or restart already active) timer.
+ *
+ * @param timer Timer to start. The structure shall be maintained by a caller
+ *     as long as the timer is active.
+ * @param period Timer period in ticks. Must not be 0 or greater than
+ *     @ref COOP_MAX_PERIOD.
+ * @param periodic If @c true the timer is periodic, that is restarted with
+ *     the same period after its expiration. Periodic timer expiration times
+ *     are calculated relatively to the timer start, therefore don't drift.
+ *     Otherwise the timer is one-shot.
+ * @param cb Timer callback. The argument is required.
+ * @param arg User argument passed untouched to the callback.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument.
+ *
+ * @note The timer callback is run by the scheduler, therefore shall not call
+ *     routines intended to be called from a thread routine only. Similarly to
+ *     threads the callback shall be short to not block the scheduler. It's
+ *     allowed to start/stop timers, notify or schedule threads from within the
+ *     callback.
+ *
+ * @note Timers expiration is taken into account while calculating the system
+ *     idle time (see @ref coop_idle_cb()), therefore no additional wake-ups
+ *     are required to handle them.
+ *
+ * @note To be called from a thread routine, a timer callback or before the
+ *     scheduler is started.
+ */
+coop_error_t coop_timer_start(coop_timer_t *timer, coop_tick_t period,
+    bool periodic, coop_timer_proc_t cb, void *arg);
+
+/**
+ * Stop the timer. No-op for not active timer.
+ *
+ * @see coop_timer_start() for notes.
+ */
+void coop_timer_stop(coop_timer_t *timer);
+#endif /* CONFIG_OPT_TIMERS */
+
+#if CONFIG_OPT_EVGROUPS
+/**
+ * Event group. A set of event bits (flags) threads may wait on.
+ *
+ * @note Initialize the structure with zeroed bits or with
+ *     @ref COOP_EVGROUP_INIT.
+ */
+typedef struct
+{
+    /** Event bits. Shall be modified via the event group API only. */
+    volatile unsigned bits;
+} coop_evgroup_t;
+
+/** Event group initializer. */
+#define COOP_EVGROUP_INIT {0}
+
+/**
+ * Wait for event bits of an event group.
+ *
+ * @param grp Event group.
+ * @param mask Awaited event bits. Must not be 0.
+ * @param all If @c true wait for all bits of @c mask to be set, otherwise
+ *     wait for any of them.
+ * @param clear If @c true awaited bits are cleared on successful wait exit.
+ * @param timeout Waiting timeout. Pass 0 for infinite wait.
+ * @param bits If not @c NULL event group bits are written under the address:
+ *     at the time the wait condition has been met (before clearing), or at
+ *     the timeout time.
+ *
+ * @return COOP_SUCCESS Awaited bits set.
+ * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL).
+ * @return COOP_ERR_INV_ARG Invalid argument(s).
+ *
+ * @note The routine returns immediately if the awaited bits are already set.
+ *     The bits check and the waiter registration are atomic with respect to
+ *     @ref coop_evgroup_set() called by ISR, so no bits setting is lost.
  *
  * @note To be called from the thread routine only.
+ * @see coop_wait() for additional notes.
  */
-size_t coop_stack_wm();
+coop_error_t coop_evgroup_wait(coop_evgroup_t *grp, unsigned mask, bool all,
+    bool clear, coop_tick_t timeout, unsigned *bits);
+
+/**
+ * Set event bits of an event group. Threads waiting for the bits are
+ * woken-up. Matching waiters against the group's bits is performed by the
+ * library by a bitmask test only, with no user code called.
+ *
+ * @note To be called from an arbitrary routine including ISR. The event
+ *     group bits and the waiters are updated in the ISR critical section
+ *     (see @ref coop_isr_lock_cb()), including the threads pool scan.
+ * @see coop_notify() for additional notes.
+ */
+void coop_evgroup_set(coop_evgroup_t *grp, unsigned bits);
+
+/**
+ * Clear event bits of an event group.
+ *
+ * @note To be called from an arbitrary routine including ISR. The bits are
+ *     updated in the ISR critical section (see @ref coop_isr_lock_cb()).
+ */
+void coop_evgroup_clear(coop_evgroup_t *grp, unsigned bits);
+#endif /* CONFIG_OPT_EVGROUPS */
+
+#if CONFIG_OPT_WORKERS
+/**
+ * Work item.
+ */
+typedef struct
+{
+    /** Work routine. */
+    coop_thrd_proc_t proc;
+
+    /** User argument passed untouched to the work routine. */
+    void *arg;
+} coop_work_t;
+
+/**
+ * Worker threads pool. Fixed number of long-living worker threads process work
+ * items submitted to the bounded work queue. Idle workers wait for incoming
+ * work items.
+ *
+ * A worker thread may be canceled (@c CONFIG_OPT_CANCEL) while idle or between
+ * work items; the worker leaves the pool and the remaining items are processed
+ * by the other workers. Work routine run by a cancel-pending worker shall
+ * return without reaching a cancellation point (see @ref coop_cancel_pending()),
+ * otherwise the worker is terminated with its pool slot still accounted.
+ *
+ * @note The structure is to be treated as opaque and accessed by the workers
+ *     pool API only.
+ */
+typedef struct
+{
+    /** Work items queue (ring buffer) and its size. */
+    coop_work_t *queue;
+    unsigned queue_sz;
+
+    /** Queue head and number of work items on the queue. */
+    unsigned head;
+    unsigned len;
+
+    /** Base semaphore id. */
+    int sem_id;
+
+    /** Number of running, idle workers and submitters waiting for space. */
+    unsigned workers_n;
+    unsigned idle_n;
+    unsigned put_wait_n;
+
+    /** Workers stop requested. */
+    bool stop;
+} coop_workers_t;
+
+/**
+ * Initialize workers pool and schedule its worker threads.
+ *
+ * @param wrks Workers pool to initialize. The structure shall be maintained by
+ *     a caller until all the workers finish.
+ * @param queue Work items queue buffer of @c queue_sz size. The buffer shall
+ *     be maintained by a caller until all the workers finish.
+ * @param queue_sz Work items queue size (max. number of pending work items).
+ * @param sem_id Base semaphore id. The workers pool uses two consecutive
+ *     semaphore ids: @c sem_id (work available) and @c sem_id+1 (queue space
+ *     available). The ids shall not be used for other purposes.
+ * @param workers_n Number of worker threads.
+ * @param name Worker threads name. May be @c NULL.
+ * @param stack_sz Worker threads stack size. If 0 default value configured by
+ *     @c CONFIG_DEFAULT_STACK_SIZE is used. The stack shall be large enough to
+ *     run the submitted work routines.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument.
+ * @return COOP_ERR_LIMIT Maximum number of threads reached. Worker threads
+ *     scheduled before the error occurred are still running.
+ */
+coop_error_t coop_workers_init(coop_workers_t *wrks, coop_work_t *queue,
+    unsigned queue_sz, int sem_id, unsigned workers_n, const char *name,
+    size_t stack_sz);
+
+/**
+ * Submit a work item to the workers pool. A single idle worker is woken-up
+ * to process the item.
+ *
+ * @param wrks Workers pool.
+ * @param proc Work routine. The argument is required.
+ * @param arg User argument passed untouched to the work routine.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument or the workers pool stopped.
+ * @return COOP_ERR_LIMIT Work items queue is full.
+ *
+ * @note To be called from the thread routine only.
+ */
+coop_error_t coop_submit(coop_workers_t *wrks, coop_thrd_proc_t proc, void *arg);
+
+/**
+ * Similar to @ref coop_submit() but waits for the queue space if the work
+ * items queue is full.
+ *
+ * @param timeout Timeout the routine waits for the queue space. Pass 0 for
+ *     infinite wait.
+ *
+ * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL).
+ * @see coop_submit() for other arguments and returned values.
+ *
+ * @note To be called from the thread routine only.
+ */
+coop_error_t coop_submit_wait(coop_workers_t *wrks,
+    coop_thrd_proc_t proc, void *arg, coop_tick_t timeout);
+
+/**
+ * Stop the workers pool. Worker threads finish after all already submitted
+ * work items are processed. No new work items are accepted after the call.
+ */
+void coop_workers_stop(coop_workers_t *wrks);
+#endif /* CONFIG_OPT_WORKERS */
+
+#if CONFIG_OPT_RWLOCK
+/**
+ * Reader-writer lock. Multiple readers or a single writer may hold the lock at
+ * a time. Writers are preferred: a new reader doesn't acquire the lock while
+ * there are writers waiting for it. After the last writer releases the lock,
+ * all readers waiting for it are released at once.
+ *
+ * Uncontended lock acquisition doesn't yield the calling thread. Since the
+ * threads are cooperative, a read section not spanning a yield point needs
+ * no locking at all as long as writers don't yield while holding the lock.
+ *
+ * @note The structure is to be treated as opaque and accessed by the rwlock
+ *     API only.
+ */
+typedef struct
+{
+    /** Base semaphore id. */
+    int sem_id;
+
+    /** Number of readers holding the lock. */
+    unsigned readers;
+
+    /** Number of readers and writers waiting for the lock. */
+    unsigned rd_wait_n;
+    unsigned wr_wait_n;
+
+    /** Writer holds the lock. */
+    bool writer;
+} coop_rwlock_t;
+
+/**
+ * Initialize reader-writer lock.
+ *
+ * @param lock Lock to initialize.
+ * @param sem_id Base semaphore id. The lock uses two consecutive semaphore
+ *     ids: @c sem_id (waiting readers) and @c sem_id+1 (waiting writers). The
+ *     ids shall not be used for other purposes.
+ */
+void coop_rwlock_init(coop_rwlock_t *lock, int sem_id);
+
+/**
+ * Acquire the lock for reading.
+ *
+ * @param lock Reader-writer lock.
+ * @param timeout Timeout the routine waits for the lock. Pass 0 for infinite
+ *     wait.
+ *
+ * @return COOP_SUCCESS Lock acquired.
+ * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL).
+ *
+ * @note To be called from the thread routine only.
+ */
+coop_error_t coop_rwlock_rdlock(coop_rwlock_t *lock, coop_tick_t timeout);
+
+/**
+ * Release the lock acquired by @ref coop_rwlock_rdlock().
+ */
+void coop_rwlock_rdunlock(coop_rwlock_t *lock);
+
+/**
+ * Acquire the lock for writing.
+ *
+ * @see coop_rwlock_rdlock() for arguments and returned values.
+ *
+ * @note To be called from the thread routine only.
+ */
+coop_error_t coop_rwlock_wrlock(coop_rwlock_t *lock, coop_tick_t timeout);
+
+/**
+ * Release the lock acquired by @ref coop_rwlock_wrlock().
+ */
+void coop_rwlock_wrunlock(coop_rwlock_t *lock);
+#endif /* CONFIG_OPT_RWLOCK */
+
+#if CONFIG_OPT_BARRIER
+/**
+ * Reusable barrier. A fixed number of threads (parties) wait on the barrier
+ * until all of them arrive. The last arriving thread releases the others and
+ * the barrier is reset for the next generation.
+ *
+ * @note The structure is to be treated as opaque and accessed by the barrier
+ *     API only.
+ */
+typedef struct
+{
+    /** Semaphore id. */
+    int sem_id;
+
+    /** Number of parties and parties arrived in the current generation. */
+    unsigned parties;
+    unsigned arrived;
+
+    /** Barrier generation. */
+    unsigned gen;
+} coop_barrier_t;
+
+/**
+ * Initialize barrier.
+ *
+ * @param bar Barrier to initialize.
+ * @param sem_id Semaphore id used by the barrier. The id shall not be used
+ *     for other purposes.
+ * @param parties Number of threads synchronized on the barrier.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument.
+ */
+coop_error_t coop_barrier_init(coop_barrier_t *bar, int sem_id, unsigned parties);
+
+/**
+ * Arrive at the barrier and wait for the other parties.
+ *
+ * @param bar Barrier.
+ * @param timeout Timeout the routine waits for the other parties. Pass 0 for
+ *     infinite wait.
+ *
+ * @return COOP_SUCCESS All the parties arrived.
+ * @return COOP_ERR_TIMEOUT Timeout reached. The thread is withdrawn from the
+ *     current barrier generation.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL). The thread
+ *     is withdrawn from the current barrier generation.
+ *
+ * @note To be called from the thread routine only.
+ */
+coop_error_t coop_barrier_wait(coop_barrier_t *bar, coop_tick_t timeout);
+
+/**
+ * One-shot countdown latch. Threads wait on the latch until its counter is
+ * counted down to zero.
+ *
+ * @note The structure is to be treated as opaque and accessed by the latch
+ *     API only.
+ */
+typedef struct
+{
+    /** Semaphore id. */
+    int sem_id;
+
+    /** Latch counter. */
+    unsigned count;
+} coop_latch_t;
+
+/**
+ * Initialize countdown latch.
+ *
+ * @param latch Latch to initialize.
+ * @param sem_id Semaphore id used by the latch. The id shall not be used
+ *     for other purposes.
+ * @param count Initial counter value.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument.
+ */
+coop_error_t coop_latch_init(coop_latch_t *latch, int sem_id, unsigned count);
+
+/**
+ * Count down the latch. All the waiting threads are released in one pass
+ * when the counter reaches zero. No-op for already released latch.
+ *
+ * @note To be called from an arbitrary routine including ISR.
+ */
+void coop_latch_count_down(coop_latch_t *latch);
+
+/**
+ * Wait for the latch counter to reach zero. Returns immediately if the latch
+ * is already released.
+ *
+ * @param latch Countdown latch.
+ * @param timeout Waiting timeout. Pass 0 for infinite wait.
+ *
+ * @return COOP_SUCCESS Latch released.
+ * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL).
+ *
+ * @note To be called from the thread routine only.
+ */
+coop_error_t coop_latch_wait(coop_latch_t *latch, coop_tick_t timeout);
+#endif /* CONFIG_OPT_BARRIER */
+
+#if CONFIG_OPT_BUFPOOL
+/**
+ * Reference counted buffer of the statically allocated buffers pool (sized by
+ * @c CONFIG_BUFPOOL_BUFS and @c CONFIG_BUFPOOL_BUF_SZ). The buffers are passed
+ * between threads by pointers, with no data copying involved. A buffer returns
+ * to the pool after its last reference is dropped.
+ */
+typedef struct coop_buf
+{
+    /** Buffer data. */
+    unsigned char data[CONFIG_BUFPOOL_BUF_SZ];
+
+    /** Data length. Set to 0 on allocation, maintained by the buffer user. */
+    size_t len;
+
+    /** Reference counter (internal). */
+    unsigned refs;
+} coop_buf_t;
+
+/**
+ * Initialize the buffers pool. All the buffers are marked as free.
+ *
+ * @param sem_id Semaphore id used to wait for a free buffer. The id shall not
+ *     be used for other purposes.
+ *
+ * @note The routine shall be called before any other buffers pool routine and
+ *     while no buffer is in use.
+ */
+void coop_bufpool_init(int sem_id);
+
+/**
+ * Allocate a buffer from the pool. The returned buffer has its reference
+ * counter set to 1.
+ *
+ * @return Allocated buffer or @c NULL if the pool is exhausted.
+ */
+coop_buf_t *coop_buf_try_alloc(void);
+
+/**
+ * Similar to @ref coop_buf_try_alloc() but waits for a buffer to be freed if
+ * the pool is exhausted, providing backpressure to the buffers producer.
+ *
+ * @param buf Address the allocated buffer is written under.
+ * @param timeout Timeout the routine waits for a free buffer. Pass 0 for
+ *     infinite wait.
+ *
+ * @return COOP_SUCCESS Buffer allocated.
+ * @return COOP_ERR_INV_ARG Invalid argument.
+ * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL).
+ *
+ * @note To be called from the thread routine only.
+ */
+coop_error_t coop_buf_alloc(coop_buf_t **buf, coop_tick_t timeout);
+
+/**
+ * Take an additional reference to a buffer (e.g. before passing it to another
+ * thread while still using it).
+ */
+void coop_buf_ref(coop_buf_t *buf);
+
+/**
+ * Drop a buffer reference. A buffer with no references left is returned to
+ * the pool and a single thread waiting for a free buffer is woken-up.
+ */
+void coop_buf_unref(coop_buf_t *buf);
+
+/**
+ * Get number of free buffers in the pool.
+ */
+unsigned coop_bufpool_free_n(void);
+#endif /* CONFIG_OPT_BUFPOOL */
+
+#if CONFIG_OPT_MEMPOOL || CONFIG_OPT_BUFPOOL
+/**
+ * Memory pool blocks alignment type.
+ */
+typedef union
+{
+    void *p;
+    long l;
+    double d;
+} coop_mempool_align_t;
+
+#define __COOP_MEMPOOL_ALIGN(_sz) \
+    (((_sz) + sizeof(coop_mempool_align_t) - 1) / \
+        sizeof(coop_mempool_align_t) * sizeof(coop_mempool_align_t))
+
+# if CONFIG_OPT_MEMPOOL_OWNER
+/**
+ * Memory pool block owner record (internal).
+ */
+typedef struct
+{
+    /** Owner thread handle and name. */
+    coop_thrd_t thrd;
+    const char *name;
+
+    /** Block in use. */
+    bool used;
+} coop_mempool_owner_t;
+
+#  define __COOP_MEMPOOL_HDR_SZ __COOP_MEMPOOL_ALIGN(sizeof(coop_mempool_owner_t))
+# else
+#  define __COOP_MEMPOOL_HDR_SZ 0
+# endif
+
+/**
+ * Memory pool space (in bytes) occupied by a single block of @c _blk_sz size.
+ */
+#define COOP_MEMPOOL_BLK_SZ(_blk_sz) \
+    (__COOP_MEMPOOL_HDR_SZ + __COOP_MEMPOOL_ALIGN((_blk_sz) ? (_blk_sz) : 1))
+
+/**
+ * Define properly aligned memory pool space @c _name for @c _blk_n blocks of
+ * @c _blk_sz size.
+ */
+#define COOP_MEMPOOL_MEM(_name, _blk_sz, _blk_n) \
+    coop_mempool_align_t _name[COOP_MEMPOOL_BLK_SZ(_blk_sz) * (_blk_n) / \
+        sizeof(coop_mempool_align_t)]
+
+/**
+ * Fixed-size blocks memory pool. Blocks allocation and freeing are O(1)
+ * operations with no heap involved.
+ *
+ * @note The structure is to be treated as opaque and accessed by the memory
+ *     pool API only.
+ */
+typedef struct
+{
+    /** Pool space, single block size (with its header) and number of blocks. */
+    unsigned char *mem;
+    size_t blk_sz;
+    unsigned blk_n;
+
+    /** Free blocks list and its length. */
+    void *free;
+    unsigned free_n;
+
+    /** Number of allocators waiting for a free block. */
+    unsigned wait_n;
+
+    /** Semaphore id. */
+    int sem_id;
+} coop_mempool_t;
+#endif /* CONFIG_OPT_MEMPOOL || CONFIG_OPT_BUFPOOL */
+
+#if CONFIG_OPT_MEMPOOL
+/**
+ * Initialize memory pool.
+ *
+ * @param pool Memory pool to initialize.
+ * @param mem Pool space. The space shall be aligned as
+ *     @ref coop_mempool_align_t and is best defined by @ref COOP_MEMPOOL_MEM.
+ *     The space shall be maintained by a caller for the pool lifetime.
+ * @param mem_sz Pool space size. Number of the pool blocks is calculated as
+ *     @c mem_sz / @c COOP_MEMPOOL_BLK_SZ(blk_sz).
+ * @param blk_sz Block size.
+ * @param sem_id Semaphore id used to wait for a free block. The id shall not
+ *     be used for other purposes.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument (e.g. misaligned or too small pool
+ *     space).
+ */
+coop_error_t coop_mempool_init(coop_mempool_t *pool,
+    void *mem, size_t mem_sz, size_t blk_sz, int sem_id);
+
+/**
+ * Allocate a block from the memory pool.
+ *
+ * @return Allocated block or @c NULL if the pool is exhausted.
+ */
+void *coop_mempool_try_alloc(coop_mempool_t *pool);
+
+/**
+ * Similar to @ref coop_mempool_try_alloc() but waits for a block to be freed
+ * if the pool is exhausted.
+ *
+ * @param pool Memory pool.
+ * @param blk Address the allocated block is written under.
+ * @param timeout Timeout the routine waits for a free block. Pass 0 for
+ *     infinite wait.
+ *
+ * @return COOP_SUCCESS Block allocated.
+ * @return COOP_ERR_INV_ARG Invalid argument.
+ * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL).
+ *
+ * @note To be called from the thread routine only.
+ */
+coop_error_t coop_mempool_alloc(coop_mempool_t *pool, void **blk,
+    coop_tick_t timeout);
+
+/**
+ * Free a block allocated from the memory pool. A single thread waiting for
+ * a free block is woken-up.
+ */
+void coop_mempool_free(coop_mempool_t *pool, void *blk);
+
+/**
+ * Get number of free blocks in the memory pool.
+ */
+unsigned coop_mempool_free_n(const coop_mempool_t *pool);
+
+# if CONFIG_OPT_MEMPOOL_OWNER
+/**
+ * Memory pool block callback.
+ *
+ * @param blk Allocated block.
+ * @param owner Name of the thread which allocated the block (may be @c NULL).
+ * @param arg User argument.
+ */
+typedef void (*coop_mempool_cb_t)(void *blk, const char *owner, void *arg);
+
+/**
+ * Enumerate blocks allocated from the memory pool.
+ *
+ * @param pool Memory pool.
+ * @param cur If @c true only the blocks owned by the current thread are
+ *     enumerated, all allocated blocks otherwise.
+ * @param cb Callback called for each enumerated block. May be @c NULL.
+ * @param arg User argument passed untouched to the callback.
+ *
+ * @return Number of enumerated blocks.
+ *
+ * @note Blocks allocated by a thread not being freed when the thread exits
+ *     are leaked. Called with @c cur set from the @c terminate scheduler hook
+ *     (@ref coop_set_hooks()), the routine reports the terminating thread's
+ *     leaks.
+ *
+ * @note Blocks allocated outside of threads (e.g. from @c main()) have no
+ *     owner. They are enumerated with @c NULL owner name, and never as blocks
+ *     owned by the current thread.
+ */
+unsigned coop_mempool_owned(coop_mempool_t *pool, bool cur,
+    coop_mempool_cb_t cb, void *arg);
+# endif
+#endif /* CONFIG_OPT_MEMPOOL */
+
+#if CONFIG_OPT_STACK_WM
+/**
+ * Get maximum stack usage water-mark for the current thread.
+ *
+ * @return Max stack usage water-mark in bytes.
+ *
+ * @note The routine tries to detect type of the platform stack (growing into
+ *     lower or higher addresses). Note the algorithm may not to be always
+ *     perfectly accurate therefore the returned value shall be treated merely
+ *     as an indicator while experimenting with various stack sizes.
+ *
+ * @note To be called from the thread routine only.
+ */
+size_t coop_stack_wm();
+#endif
+
+#if CONFIG_OPT_STACK_PROF
+/**
+ * Stack-size profile record of a thread.
+ */
+typedef struct
+{
+    /** Thread name (may be NULL). */
+    const char *name;
+
+    /** Thread routine; identifies the thread if no name is provided. */
+    coop_thrd_proc_t proc;
+
+    /** Maximum requested stack size. */
+    size_t stack_sz;
+
+    /** Maximum recorded stack usage water-mark. */
+    size_t wm;
+
+    /** Number of recorded samples; 0 if no water-mark has been recorded yet
+        (the thread has not yielded). */
+    unsigned samples;
+} coop_stack_prof_t;
+
+/**
+ * Stack-size profile records iteration callback.
+ */
+typedef void (*coop_stack_prof_cb_t)(const coop_stack_prof_t *prof, void *arg);
+
+/**
+ * Printf-like routine used to dump stack-size profile.
+ */
+typedef int (*coop_stack_prof_print_t)(const char *format, ...);
+
+/**
+ * Record stack usage water-marks of all running threads.
+ *
+ * Water-marks of terminating threads are recorded automatically, therefore
+ * the routine is intended to sample threads which are not intended to exit
+ * (may be called by one of the threads periodically).
+ *
+ * @note To be called from the thread routine only.
+ */
+void coop_stack_prof_sample(void);
+
+/**
+ * Iterate over the stack-size profile records.
+ */
+void coop_stack_prof_foreach(coop_stack_prof_cb_t cb, void *arg);
+
+/**
+ * Get recommended stack size for a profiled thread: the recorded water-mark
+ * with @ref CONFIG_STACK_PROF_MARGIN safety margin added, rounded up to
+ * 16 bytes. The requested stack size is returned for a thread with no
+ * water-mark recorded.
+ */
+size_t coop_stack_prof_recommend(const coop_stack_prof_t *prof);
+
+/**
+ * Dump the stack-size profile as a C header with recommended threads stack
+ * sizes, e.g.:
+ *
+ * @code
+ * #define COOP_STACK_SZ_thrd_1 0x80U // wm: 0x32, stack_sz: 0x100, samples: 1
+ * @endcode
+ *
+ * Thread name's characters not allowed in C identifiers are replaced by '_'.
+ * Threads with no names are identified by their routines addresses.
+ *
+ * @param print Printf-like routine to output the dump (e.g. @c printf()).
+ */
+void coop_stack_prof_dump(coop_stack_prof_print_t print);
+
+/**
+ * Clear the stack-size profile records.
+ */
+void coop_stack_prof_reset(void);
+#endif /* CONFIG_OPT_STACK_PROF */
+
+#if CONFIG_OPT_HOOKS
+/**
+ * Scheduler event hooks. Unused hooks shall be set to NULL.
+ *
+ * Thread related hooks are called with the thread set as the current one,
+ * therefore @ref coop_thread_name() may be used to identify the thread. The
+ * @c thrd argument is the thread's slot index in the threads pool (slots of
+ * terminated threads are reused).
+ *
+ * @note The hooks are called in the scheduler critical paths and shall be as
+ *     short as possible. The hooks must not call the library API switching
+ *     the threads context (e.g. @ref coop_yield()).
+ */
+typedef struct
+{
+    /** Thread is dispatched by the scheduler (switch-in). */
+    void (*switch_in)(unsigned thrd);
+
+    /** Thread yields back to the scheduler (switch-out). */
+    void (*switch_out)(unsigned thrd);
+
+    /** Newly created thread is started (NEW -> RUN). Followed by
+        @c switch_in for the thread. */
+    void (*spawn)(unsigned thrd);
+
+    /** Thread routine has returned; the thread is being terminated (no
+        @c switch_out called in this case). */
+    void (*terminate)(unsigned thrd);
+
+    /** System is entering the idle state for @c period ticks (0 for infinite
+        idle); called before @ref coop_idle_cb(). */
+    void (*idle_enter)(coop_tick_t period);
+
+    /** System has left the idle state; called after @ref coop_idle_cb(). */
+    void (*idle_exit)(void);
+} coop_hooks_t;
+
+/**
+ * Install scheduler event hooks table.
+ *
+ * @param hooks Hooks table to install (NULL to uninstall). The table is not
+ *     copied and must be valid while installed.
+ *
+ * @return Previously installed hooks table (may be NULL). Hooks installing
+ *     on top of another ones may chain to the returned table.
+ */
+const coop_hooks_t *coop_set_hooks(const coop_hooks_t *hooks);
+#endif /* CONFIG_OPT_HOOKS */
+
+#if CONFIG_PLATFORM_SIM
+/*
+ * Simulation platform (virtual clock) section.
+ */
+
+/**
+ * Scripted event callback type.
+ */
+typedef void (*coop_sim_proc_t)(void *arg);
+
+/**
+ * Advance the virtual clock by a number of ticks. Scripted events scheduled
+ * in the period are fired at their times.
+ *
+ * @note Intended to simulate time consumed by a thread routine, e.g. by
+ *     a busy-loop.
+ */
+void coop_sim_advance(coop_tick_t ticks);
+
+# if CONFIG_OPT_IDLE
+/**
+ * Put the simulated system into the idle state. Virtual clock advances up to
+ * the idle period end or the nearest scripted event (which wakes the system
+ * up), whatever comes first.
+ *
+ * @param period Idle period. 0 for infinite idle, possible only if there is
+ *     a scripted event to wake the system up.
+ *
+ * @note The routine implements @ref coop_idle_cb() of the simulation
+ *     platform. User's @ref coop_idle_cb() (@c CONFIG_IDLE_CB_ALT configured
+ *     explicitly) shall call it to advance the virtual clock.
+ */
+void coop_sim_idle(coop_tick_t period);
+# endif
+
+/**
+ * Schedule a scripted event fired at a given virtual tick. The event callback
+ * is called in the context of @ref coop_idle_cb() (simulating an ISR waking
+ * the system up from the idle state) or @ref coop_sim_advance().
+ *
+ * @param at Virtual tick the event is fired at.
+ * @param cb Event callback. The argument is required.
+ * @param arg User argument passed untouched to the callback.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument.
+ * @return COOP_ERR_LIMIT Max. number of scheduled events reached
+ *     (@ref CONFIG_SIM_EVENTS_MAX).
+ *
+ * @note The routine may be called from an event callback.
+ */
+coop_error_t coop_sim_event(coop_tick_t at, coop_sim_proc_t cb, void *arg);
+
+/**
+ * Reset the simulation: set the virtual clock to @c tick and remove all
+ * scheduled events.
+ */
+void coop_sim_reset(coop_tick_t tick);
+#endif /* CONFIG_PLATFORM_SIM */
+
+#if CONFIG_OPT_UNIX_PROF
+/*
+ * Unix platform sampling profiler section.
+ */
+
+/**
+ * Profile dump formats.
+ */
+typedef enum
+{
+    /** Flat profile: samples per thread followed by samples per interrupted
+        code address of the thread. */
+    COOP_PROF_FLAT = 0,
+
+    /** Collapsed stacks (one "thread;address count" line per sampled code
+        address) consumable by flame graph tools. */
+    COOP_PROF_COLLAPSED
+} coop_prof_fmt_t;
+
+/**
+ * Start the sampling profiler. @c SIGPROF signal is delivered every
+ * @c interval_us of consumed CPU time (@c setitimer(ITIMER_PROF)) and the
+ * signal handler records the running coop thread and the interrupted code
+ * address. Time spent by the scheduler and in the system idle state is
+ * attributed to "[sched]" and "[idle]" pseudo-threads ("[sched]" also covers
+ * time spent outside of the scheduler, e.g. before its start).
+ *
+ * The profiler installs scheduler event hooks (@ref coop_set_hooks()) chained
+ * to the previously installed ones.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument or the @c SIGPROF signal handler
+ *     or @c ITIMER_PROF timer setup failed.
+ * @return COOP_ERR_LIMIT The profiler is already started.
+ *
+ * @note Recorded samples are not cleared by the routine
+ *     (see @ref coop_prof_reset()).
+ */
+coop_error_t coop_prof_start(unsigned long interval_us);
+
+/**
+ * Stop the sampling profiler and restore previously installed scheduler
+ * hooks. Hooks chained to the profiler ones are to be uninstalled first
+ * (LIFO order), otherwise the profiler is not stopped.
+ *
+ * @return COOP_SUCCESS Function finished with success (or the profiler is not
+ *     started).
+ * @return COOP_ERR_LIMIT Other hooks are installed on top of the profiler
+ *     ones; the profiler keeps running.
+ */
+coop_error_t coop_prof_stop(void);
+
+/**
+ * Clear recorded samples.
+ */
+void coop_prof_reset(void);
+
+/**
+ * Get number of recorded and dropped (due to full samples buffer) samples.
+ */
+unsigned coop_prof_samples(unsigned *dropped);
+
+/**
+ * Write recorded profile to a file descriptor. Threads are identified by their
+ * names (@ref coop_thread_name()) or "thread#N" (N: thread slot index) for
+ * unnamed threads. Code addresses may be resolved by @c addr2line(1).
+ *
+ * @return 0 on success, -1 on a write error.
+ *
+ * @note @c SIGPROF signal is blocked while the routine is running.
+ *
+ * @note The recorded samples are sorted in place (by threads and code
+ *     addresses), therefore their recording order is not preserved.
+ */
+int coop_prof_dump(int fd, coop_prof_fmt_t fmt);
+#endif /* CONFIG_OPT_UNIX_PROF */
+
+#if CONFIG_OPT_UNIX_WDOG
+/*
+ * Unix platform watchdog section.
+ */
+
+/**
+ * Watchdog callback.
+ *
+ * @param thrd Thread slot index of the thread not yielding.
+ * @param name The thread's name (may be @c NULL).
+ *
+ * @note The callback is called from the signal handler context, therefore
+ *     shall use async-signal-safe functions only.
+ */
+typedef void (*coop_wdog_cb_t)(unsigned thrd, const char *name);
+
+/**
+ * Start the watchdog. The watchdog timer (@c setitimer(ITIMER_REAL)) is
+ * armed each time the scheduler switches to a thread and disarmed while the
+ * thread yields or terminates. If the thread doesn't return to the scheduler
+ * within @c timeout_us, @c SIGALRM signal handler calls the watchdog
+ * callback.
+ *
+ * The watchdog installs scheduler event hooks (@ref coop_set_hooks()) chained
+ * to the previously installed ones.
+ *
+ * @param timeout_us Watchdog timeout in microseconds.
+ * @param cb Watchdog callback. If @c NULL the default callback is used,
+ *     printing the thread name on the standard error and aborting the process
+ *     (so the thread's stack may be examined in the core dump).
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_INV_ARG Invalid argument or the @c SIGALRM signal handler
+ *     or @c ITIMER_REAL timer setup failed.
+ * @return COOP_ERR_LIMIT The watchdog is already started or @c SIGALRM signal
+ *     handler is already installed (other than @c SIG_DFL or @c SIG_IGN).
+ *
+ * @note @c SIGALRM signal and @c ITIMER_REAL timer shall not be used for other
+ *     purposes while the watchdog is running.
+ */
+coop_error_t coop_wdog_start(unsigned long timeout_us, coop_wdog_cb_t cb);
+
+/**
+ * Stop the watchdog and restore previously installed scheduler hooks. Hooks
+ * chained to the watchdog ones are to be uninstalled first (LIFO order),
+ * otherwise the watchdog is not stopped.
+ *
+ * @return COOP_SUCCESS Function finished with success (or the watchdog is not
+ *     started).
+ * @return COOP_ERR_LIMIT Other hooks are installed on top of the watchdog
+ *     ones; the watchdog keeps running.
+ */
+coop_error_t coop_wdog_stop(void);
+#endif /* CONFIG_OPT_UNIX_WDOG */
+
+/*
+ * Library internal routines (shared by the library modules).
+ */
+
+#if CONFIG_OPT_WAIT
+/**
+ * Wait on @c sem_id until @c try_fn(ctx) returns @c true, with the timeout
+ * applied to the whole waiting (0 for infinite wait). @c try_fn is checked
+ * before each wait and after each wake-up.
+ *
+ * @param wait_n If not @c NULL, counter of threads parked on @c sem_id
+ *     (incremented for the time of each wait).
+ *
+ * @return COOP_SUCCESS @c try_fn returned @c true.
+ * @return COOP_ERR_TIMEOUT Timeout reached.
+ * @return COOP_ERR_CANCELED Thread canceled (@c CONFIG_OPT_CANCEL). The
+ *     routine doesn't park a cancel-pending thread, so @c wait_n is left
+ *     balanced.
+ *
+ * @note Passing the wake-up on if the waiter gives up is up to the caller.
+ */
+coop_error_t _coop_timed_wait(int sem_id, unsigned *wait_n,
+    bool (*try_fn)(void *ctx), void *ctx, coop_tick_t timeout);
+#endif
+
+#if CONFIG_OPT_HOOKS
+/**
+ * Call @c _hook of the chained hooks table @c _prev (may be @c NULL).
+ */
+# define _COOP_HOOK_CHAIN(_prev, _hook, _args) \
+    do { if ((_prev) && (_prev)->_hook) (_prev)->_hook _args; } while (0)
+
+/**
+ * Install hooks table @c hooks on top of the currently installed ones, which
+ * are returned in @c prev for chaining.
+ */
+void _coop_hooks_push(const coop_hooks_t *hooks, const coop_hooks_t **prev);
+
+/**
+ * Uninstall hooks table @c hooks installed by @ref _coop_hooks_push() and
+ * restore @c prev tables. The tables are to be uninstalled in the LIFO order.
+ *
+ * @return COOP_SUCCESS Function finished with success.
+ * @return COOP_ERR_LIMIT Other hooks are installed on top of @c hooks (and
+ *     chain to them); the installed hooks are left intact.
+ */
+coop_error_t _coop_hooks_pop(
+    const coop_hooks_t *hooks, const coop_hooks_t *prev);
 #endif
 
 #if COOP_DEBUG
@@ -318,5 +1870,8 @@ unsigned coop_test_get_cur_thrd();
 void coop_test_set_cur_thrd(unsigned cur_thrd);
 void *coop_test_get_stack(unsigned thrd);
 void coop_test_set_stack(unsigned thrd, void *stack);
+unsigned coop_test_get_pool_size(void);
+unsigned coop_test_get_depth(void);
+const char *coop_test_check_invariants(void);
 #endif
 #endif /* __COOP_THREADS_H__ */
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+/*
+ * Worker threads pool.
+ */
+
+#include "coop_threads.h"
+
+#if CONFIG_OPT_WORKERS
+# if !CONFIG_OPT_WAIT
+#  error CONFIG_OPT_WORKERS requires CONFIG_OPT_WAIT
+# endif
+
+/* semaphore ids used by the workers pool */
+#define _SEM_WORK(_wrks)  ((_wrks)->sem_id)
+#define _SEM_SPACE(_wrks) ((_wrks)->sem_id + 1)
+
+/**
+ * Worker thread routine.
+ */
+static void _worker_proc(void *arg)
+{
+    coop_workers_t *wrks = (coop_workers_t*)arg;
+    coop_work_t work;
+    coop_error_t ret;
+
+    for (;;)
+    {
+        while (!wrks->len) {
+            if (wrks->stop) goto finish;
+
+            /* park the worker until a work item is submitted */
+            wrks->idle_n++;
+            ret = coop_wait(_SEM_WORK(wrks), 0);
+            wrks->idle_n--;
+
+            if (ret != COOP_SUCCESS) goto finish;
+        }
+# if CONFIG_OPT_CANCEL
+        /* canceled worker leaves the queued items for the others */
+        if (coop_cancel_pending()) goto finish;
+# endif
+
+        work = wrks->queue[wrks->head];
+        wrks->head = (wrks->head + 1) % wrks->queue_sz;
+        wrks->len--;
+
+        if (wrks->put_wait_n > 0) {
+            /* queue space is available for a waiting submitter */
+            coop_notify(_SEM_SPACE(wrks));
+        }
+
+        work.proc(work.arg);
+    }
+
+finish:
+    wrks->workers_n--;
+    if (wrks->len > 0 && wrks->idle_n > 0) {
+        /* pass the work on if the worker gave up */
+        coop_notify(_SEM_WORK(wrks));
+    }
+    coop_dbg_log_cb("Worker %s exits; %u workers left\n",
+        coop_thread_name(), wrks->workers_n);
+}
+
+coop_error_t coop_workers_init(coop_workers_t *wrks, coop_work_t *queue,
+    unsigned queue_sz, int sem_id, unsigned workers_n, const char *name,
+    size_t stack_sz)
+{
+    coop_error_t ret = COOP_SUCCESS;
+
+    if (!wrks || !queue || !queue_sz || !workers_n) {
+        return COOP_ERR_INV_ARG;
+    }
+
+    wrks->queue = queue;
+    wrks->queue_sz = queue_sz;
+    wrks->head = wrks->len = 0;
+    wrks->sem_id = sem_id;
+    wrks->workers_n = wrks->idle_n = wrks->put_wait_n = 0;
+    wrks->stop = false;
+
+    for (; wrks->workers_n < workers_n; wrks->workers_n++) {
+        ret = coop_sched_thread(_worker_proc, name, stack_sz, wrks);
+        if (ret != COOP_SUCCESS) break;
+    }
+    return ret;
+}
+
+/**
+ * Put a work item on the queue. The queue is assumed not to be full.
+ */
+static void _put_work(coop_workers_t *wrks, coop_thrd_proc_t proc, void *arg)
+{
+    unsigned tail = (wrks->head + wrks->len) % wrks->queue_sz;
+
+    wrks->queue[tail].proc = proc;
+    wrks->queue[tail].arg = arg;
+    wrks->len++;
+
+    if (wrks->idle_n > 0) {
+        /* wake up a single parked worker */
+        coop_notify(_SEM_WORK(wrks));
+    }
+}
+
+coop_error_t coop_submit(coop_workers_t *wrks, coop_thrd_proc_t proc, void *arg)
+{
+    if (!proc || wrks->stop) {
+        return COOP_ERR_INV_ARG;
+    } else if (wrks->len >= wrks->queue_sz) {
+        return COOP_ERR_LIMIT;
+    }
+
+    _put_work(wrks, proc, arg);
+    return COOP_SUCCESS;
+}
+
+static bool _has_space(void *ctx)
+{
+    coop_workers_t *wrks = (coop_workers_t*)ctx;
+    return (wrks->len < wrks->queue_sz);
+}
+
+coop_error_t coop_submit_wait(coop_workers_t *wrks,
+    coop_thrd_proc_t proc, void *arg, coop_tick_t timeout)
+{
+    coop_error_t ret;
+
+    if (!proc || wrks->stop) return COOP_ERR_INV_ARG;
+
+    /* wait for the queue space */
+    ret = _coop_timed_wait(_SEM_SPACE(wrks), &wrks->put_wait_n, _has_space,
+        wrks, timeout);
+
+    if (ret != COOP_SUCCESS) {
+        if (_has_space(wrks) && wrks->put_wait_n > 0) {
+            /* pass the wake-up on if the waiter gave up */
+            coop_notify(_SEM_SPACE(wrks));
+        }
+        return ret;
+    }
+
+    _put_work(wrks, proc, arg);
+    return COOP_SUCCESS;
+}
+
+void coop_workers_stop(coop_workers_t *wrks)
+{
+    wrks->stop = true;
+
+    /* parked workers exit; the busy ones exit after the queue is drained */
+    coop_notify_all(_SEM_WORK(wrks));
+}
+#endif /* CONFIG_OPT_WORKERS */
@@ -66,5 +66,39 @@ void coop_idle_cb(coop_tick_t period)
 }
 #endif
 
+#if (CONFIG_OPT_WAIT_DEFER_PREDIC || CONFIG_OPT_EVGROUPS) && \
+    !CONFIG_ISR_LOCK_CB_ALT
+/**
+ * ISR critical section enter callback (interrupts masking).
+ */
+unsigned coop_isr_lock_cb(void)
+{
+# if defined(ARDUINO_ARCH_AVR)
+    unsigned state = SREG;
+# elif defined(__arm__)
+    unsigned state = __get_PRIMASK();
+# else
+    unsigned state = 1;
+# endif
+    noInterrupts();
+    return state;
+}
+
+/**
+ * ISR critical section leave callback.
+ */
+void coop_isr_unlock_cb(unsigned state)
+{
+# if defined(ARDUINO_ARCH_AVR)
+    SREG = (uint8_t)state;
+# elif defined(__arm__)
+    __set_PRIMASK(state);
+# else
+    /* no portable way to get the previous interrupts state */
+    if (state) interrupts();
+# endif
+}
+#endif
+
 } /* extern "C" */
 #endif /* ARDUINO */
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+/*
+ * Simulation platform: virtual clock callbacks implementation.
+ *
+ * The virtual tick counter advances only while the system goes idle or on
+ * explicit coop_sim_advance() calls, therefore idle periods pass instantly
+ * and timing of the simulated scenario is fully deterministic. External
+ * events (e.g. ISRs notifying threads) may be scripted at virtual times.
+ */
+
+#include "coop_threads.h"
+
+#if CONFIG_PLATFORM_SIM
+#include <stdio.h>
+#include <stdlib.h> /* abort() */
+#include <string.h> /* memset() */
+
+/**
+ * Scripted event.
+ */
+typedef struct
+{
+    /** Event is scheduled. */
+    bool used;
+
+    /** Virtual tick the event is fired at. */
+    coop_tick_t at;
+
+    /** Event callback and its argument. */
+    coop_sim_proc_t cb;
+    void *arg;
+} coop_sim_event_t;
+
+/**
+ * Simulation context.
+ */
+static struct
+{
+    /** Virtual tick counter. */
+    coop_tick_t tick;
+
+    /** Scripted events. */
+    coop_sim_event_t events[CONFIG_SIM_EVENTS_MAX];
+} sim;
+
+/**
+ * Get the nearest scheduled event or @c NULL if there is no scheduled event.
+ * Events scheduled at the same tick are returned in their slots order.
+ */
+static coop_sim_event_t *_next_event(void)
+{
+    coop_sim_event_t *next = NULL;
+
+    for (unsigned i = 0; i < CONFIG_SIM_EVENTS_MAX; i++) {
+        if (sim.events[i].used &&
+            (!next || !COOP_IS_TICK_OVER(sim.events[i].at, next->at)))
+        {
+            next = &sim.events[i];
+        }
+    }
+    return next;
+}
+
+/**
+ * Fire all events scheduled up to the current virtual tick.
+ *
+ * @return Number of fired events.
+ */
+static unsigned _fire_events(void)
+{
+    unsigned n = 0;
+    coop_sim_event_t *ev;
+
+    while ((ev = _next_event()) != NULL && COOP_IS_TICK_OVER(sim.tick, ev->at))
+    {
+        /* the event may schedule a new one in the freed slot */
+        ev->used = false;
+        ev->cb(ev->arg);
+        n++;
+    }
+    return n;
+}
+
+/**
+ * Get clock tick callback (virtual ticks).
+ */
+coop_tick_t coop_tick_cb()
+{
+    return sim.tick;
+}
+
+#if CONFIG_OPT_IDLE
+void coop_sim_idle(coop_tick_t period)
+{
+    coop_sim_event_t *ev = _next_event();
+
+    if (!period && !ev) {
+        /* nothing may wake the system up */
+        fprintf(stderr, "coop_sim: infinite idle with no scripted events\n");
+        abort();
+    }
+
+    if (ev && (!period || COOP_IS_TICK_OVER(sim.tick + period, ev->at))) {
+        if (!COOP_IS_TICK_OVER(sim.tick, ev->at)) sim.tick = ev->at;
+        _fire_events();
+    } else {
+        sim.tick += period;
+    }
+}
+
+# if __COOP_SIM_IDLE_CB
+/**
+ * System idle callback (virtual clock idle).
+ */
+void coop_idle_cb(coop_tick_t period)
+{
+    coop_sim_idle(period);
+}
+# endif
+#endif
+
+void coop_sim_advance(coop_tick_t ticks)
+{
+    coop_sim_event_t *ev;
+    coop_tick_t end = sim.tick + ticks;
+
+    /* events are fired at their times */
+    while ((ev = _next_event()) != NULL && COOP_IS_TICK_OVER(end, ev->at)) {
+        if (!COOP_IS_TICK_OVER(sim.tick, ev->at)) sim.tick = ev->at;
+        _fire_events();
+    }
+    sim.tick = end;
+}
+
+coop_error_t coop_sim_event(coop_tick_t at, coop_sim_proc_t cb, void *arg)
+{
+    if (!cb) return COOP_ERR_INV_ARG;
+
+    for (unsigned i = 0; i < CONFIG_SIM_EVENTS_MAX; i++) {
+        if (!sim.events[i].used) {
+            sim.events[i].used = true;
+            sim.events[i].at = at;
+            sim.events[i].cb = cb;
+            sim.events[i].arg = arg;
+            return COOP_SUCCESS;
+        }
+    }
+    return COOP_ERR_LIMIT;
+}
+
+void coop_sim_reset(coop_tick_t tick)
+{
+    memset(&sim, 0, sizeof(sim));
+    sim.tick = tick;
+}
+#endif /* CONFIG_PLATFORM_SIM */
@@ -53,4 +53,26 @@ void coop_idle_cb(coop_tick_t period)
     HAL_Delay(period);
 }
 #endif
+
+#if (CONFIG_OPT_WAIT_DEFER_PREDIC || CONFIG_OPT_EVGROUPS) && \
+    !CONFIG_ISR_LOCK_CB_ALT
+/**
+ * ISR critical section enter callback (interrupts masking).
+ */
+unsigned coop_isr_lock_cb(void)
+{
+    unsigned state = __get_PRIMASK();
+
+    __disable_irq();
+    return state;
+}
+
+/**
+ * ISR critical section leave callback.
+ */
+void coop_isr_unlock_cb(unsigned state)
+{
+    __set_PRIMASK(state);
+}
+#endif
 #endif /* __STM32_HAL__ */
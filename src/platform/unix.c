@@ -15,6 +15,7 @@
  */
 
 #ifdef __unix__
+#include <signal.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <time.h>
@@ -58,4 +59,33 @@ void coop_idle_cb(coop_tick_t period)
     usleep((useconds_t)period * 1000U);
 }
 #endif
+
+#if (CONFIG_OPT_WAIT_DEFER_PREDIC || CONFIG_OPT_EVGROUPS) && \
+    !CONFIG_ISR_LOCK_CB_ALT
+/* signals mask before the outermost critical section; nesting level */
+static sigset_t isr_lock_mask;
+static unsigned isr_lock_n;
+
+/**
+ * ISR critical section enter callback (signals handlers play the ISRs role).
+ */
+unsigned coop_isr_lock_cb(void)
+{
+    sigset_t all, prev;
+
+    sigfillset(&all);
+    sigprocmask(SIG_BLOCK, &all, &prev);
+    if (!isr_lock_n++) isr_lock_mask = prev;
+    return 0;
+}
+
+/**
+ * ISR critical section leave callback.
+ */
+void coop_isr_unlock_cb(unsigned state)
+{
+    (void)state;
+    if (!--isr_lock_n) sigprocmask(SIG_SETMASK, &isr_lock_mask, NULL);
+}
+#endif
 #endif /* __unix__ */
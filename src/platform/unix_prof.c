@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+/*
+ * UNIX platform sampling profiler.
+ *
+ * All coop threads share the process (OS thread) stack, therefore OS level
+ * profilers are not able to distinguish them. The profiler takes CPU time
+ * samples by SIGPROF signal handler and attributes them to the coop thread
+ * being run at the sampling time, which is tracked by the scheduler hooks.
+ */
+
+#ifdef __unix__
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE    /* REG_xxx registers indexes */
+#endif
+#include "coop_threads.h"
+
+#if CONFIG_OPT_UNIX_PROF
+#if !CONFIG_OPT_HOOKS
+# error CONFIG_OPT_UNIX_PROF requires CONFIG_OPT_HOOKS
+#endif
+
+#include <signal.h>
+#include <stdint.h> /* uintptr_t */
+#include <stdio.h>  /* dprintf(), snprintf() */
+#include <stdlib.h> /* qsort() */
+#include <string.h> /* memset(), strcmp() */
+#include <sys/time.h>
+#include <ucontext.h>
+
+/* pseudo-threads indexes */
+#define PROF_SCHED  ((unsigned)-1)
+#define PROF_IDLE   ((unsigned)-2)
+
+/**
+ * Profiler sample.
+ */
+typedef struct
+{
+    /** Thread slot index or pseudo-thread index. */
+    unsigned thrd;
+
+    /** Thread name (may be NULL). */
+    const char *name;
+
+    /** Interrupted code address. */
+    uintptr_t pc;
+} prof_sample_t;
+
+static void _switch_in(unsigned thrd);
+static void _switch_out(unsigned thrd);
+static void _spawn(unsigned thrd);
+static void _terminate(unsigned thrd);
+static void _idle_enter(coop_tick_t period);
+static void _idle_exit(void);
+
+static const coop_hooks_t prof_hooks = {
+    _switch_in, _switch_out, _spawn, _terminate, _idle_enter, _idle_exit
+};
+
+/**
+ * Profiler context.
+ */
+static struct
+{
+    /** Profiler started flag. */
+    bool started;
+
+    /** Hooks installed before the profiler ones. */
+    const coop_hooks_t *prev_hooks;
+
+    /** SIGPROF action replaced by the profiler. */
+    struct sigaction prev_act;
+
+    /** Currently running thread (as seen by the signal handler). */
+    volatile unsigned cur_thrd;
+    const char *volatile cur_name;
+
+    /** Number of recorded and dropped samples. Updated by the signal
+        handler only (single producer). */
+    volatile sig_atomic_t samples_n;
+    volatile sig_atomic_t dropped_n;
+
+    prof_sample_t samples[CONFIG_UNIX_PROF_SAMPLES];
+} prof;
+
+/*
+ * Scheduler hooks tracking currently running thread. Chained to the hooks
+ * installed before the profiler.
+ */
+static void _switch_in(unsigned thrd)
+{
+    /* name need to be set before the thread index */
+    prof.cur_name = coop_thread_name();
+    prof.cur_thrd = thrd;
+
+    _COOP_HOOK_CHAIN(prof.prev_hooks, switch_in, (thrd));
+}
+
+static void _switch_out(unsigned thrd)
+{
+    prof.cur_thrd = PROF_SCHED;
+
+    _COOP_HOOK_CHAIN(prof.prev_hooks, switch_out, (thrd));
+}
+
+static void _spawn(unsigned thrd)
+{
+    _COOP_HOOK_CHAIN(prof.prev_hooks, spawn, (thrd));
+}
+
+static void _terminate(unsigned thrd)
+{
+    prof.cur_thrd = PROF_SCHED;
+
+    _COOP_HOOK_CHAIN(prof.prev_hooks, terminate, (thrd));
+}
+
+static void _idle_enter(coop_tick_t period)
+{
+    prof.cur_thrd = PROF_IDLE;
+
+    _COOP_HOOK_CHAIN(prof.prev_hooks, idle_enter, (period));
+}
+
+static void _idle_exit(void)
+{
+    prof.cur_thrd = PROF_SCHED;
+
+    _COOP_HOOK_CHAIN(prof.prev_hooks, idle_exit, ());
+}
+
+/**
+ * Get interrupted code address from the signal context.
+ */
+static uintptr_t _sig_pc(void *uctx)
+{
+    ucontext_t *uc = (ucontext_t*)uctx;
+
+#if defined(__linux__) && defined(__x86_64__)
+    return (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__linux__) && defined(__i386__)
+    return (uintptr_t)uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__linux__) && defined(__aarch64__)
+    return (uintptr_t)uc->uc_mcontext.pc;
+#elif defined(__linux__) && defined(__arm__)
+    return (uintptr_t)uc->uc_mcontext.arm_pc;
+#else
+    /* address not supported; samples attributed to threads only */
+    (void)uc;
+    return 0;
+#endif
+}
+
+/**
+ * SIGPROF signal handler.
+ */
+static void _sigprof_handler(int sig, siginfo_t *info, void *uctx)
+{
+    sig_atomic_t i = prof.samples_n;
+    (void)sig;
+    (void)info;
+
+    if (i < CONFIG_UNIX_PROF_SAMPLES) {
+        prof.samples[i].thrd = prof.cur_thrd;
+        prof.samples[i].name = prof.cur_name;
+        prof.samples[i].pc = _sig_pc(uctx);
+
+        /* publish the sample */
+        prof.samples_n = i + 1;
+    } else {
+        prof.dropped_n++;
+    }
+}
+
+/**
+ * Get sample's thread label.
+ */
+static const char *_label(const prof_sample_t *smpl, char *buf, size_t buf_sz)
+{
+    if (smpl->thrd == PROF_SCHED) return "[sched]";
+    if (smpl->thrd == PROF_IDLE) return "[idle]";
+    if (smpl->name) return smpl->name;
+
+    snprintf(buf, buf_sz, "thread#%u", smpl->thrd);
+    return buf;
+}
+
+/**
+ * Samples threads order (by thread label).
+ */
+static int _thrd_cmp(const prof_sample_t *sa, const prof_sample_t *sb)
+{
+    char buf_a[16], buf_b[16];
+
+    return strcmp(_label(sa, buf_a, sizeof(buf_a)),
+        _label(sb, buf_b, sizeof(buf_b)));
+}
+
+/**
+ * Samples order: by thread label, then by code address.
+ */
+static int _smpl_cmp(const void *a, const void *b)
+{
+    const prof_sample_t *sa = (const prof_sample_t*)a;
+    const prof_sample_t *sb = (const prof_sample_t*)b;
+    int res = _thrd_cmp(sa, sb);
+
+    if (!res) res = (sa->pc > sb->pc) - (sa->pc < sb->pc);
+    return res;
+}
+
+coop_error_t coop_prof_start(unsigned long interval_us)
+{
+    struct sigaction act;
+    struct itimerval itv;
+
+    if (!interval_us) return COOP_ERR_INV_ARG;
+    if (prof.started) return COOP_ERR_LIMIT;
+
+    prof.cur_thrd = PROF_SCHED;
+
+    /* the handler is installed before the hooks and the timer */
+    memset(&act, 0, sizeof(act));
+    act.sa_sigaction = _sigprof_handler;
+    act.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&act.sa_mask);
+    if (sigaction(SIGPROF, &act, &prof.prev_act)) return COOP_ERR_INV_ARG;
+
+    _coop_hooks_push(&prof_hooks, &prof.prev_hooks);
+
+    itv.it_interval.tv_sec = interval_us / 1000000LU;
+    itv.it_interval.tv_usec = interval_us % 1000000LU;
+    itv.it_value = itv.it_interval;
+    if (setitimer(ITIMER_PROF, &itv, NULL))
+    {
+        /* roll back */
+        _coop_hooks_pop(&prof_hooks, prof.prev_hooks);
+        sigaction(SIGPROF, &prof.prev_act, NULL);
+        return COOP_ERR_INV_ARG;
+    }
+
+    prof.started = true;
+    return COOP_SUCCESS;
+}
+
+coop_error_t coop_prof_stop(void)
+{
+    static const struct itimerval itv_off = {{0, 0}, {0, 0}};
+
+    if (!prof.started) return COOP_SUCCESS;
+
+    /* hooks chaining to the profiler ones need to be uninstalled first */
+    if (_coop_hooks_pop(&prof_hooks, prof.prev_hooks) != COOP_SUCCESS)
+        return COOP_ERR_LIMIT;
+
+    setitimer(ITIMER_PROF, &itv_off, NULL);
+    sigaction(SIGPROF, &prof.prev_act, NULL);
+
+    prof.started = false;
+    return COOP_SUCCESS;
+}
+
+void coop_prof_reset(void)
+{
+    sigset_t set, old_set;
+
+    sigemptyset(&set);
+    sigaddset(&set, SIGPROF);
+    sigprocmask(SIG_BLOCK, &set, &old_set);
+
+    prof.samples_n = 0;
+    prof.dropped_n = 0;
+
+    sigprocmask(SIG_SETMASK, &old_set, NULL);
+}
+
+unsigned coop_prof_samples(unsigned *dropped)
+{
+    if (dropped) *dropped = (unsigned)prof.dropped_n;
+    return (unsigned)prof.samples_n;
+}
+
+int coop_prof_dump(int fd, coop_prof_fmt_t fmt)
+{
+    sigset_t set, old_set;
+    unsigned i, j, k, n, thrd_n, pc_n;
+    char buf[16];
+    const char *label;
+    int ret = 0;
+
+    sigemptyset(&set);
+    sigaddset(&set, SIGPROF);
+    sigprocmask(SIG_BLOCK, &set, &old_set);
+
+    /* sorted in place; no copy of the (possibly large) samples buffer */
+    n = (unsigned)prof.samples_n;
+    qsort(prof.samples, n, sizeof(prof.samples[0]), _smpl_cmp);
+
+    if (fmt == COOP_PROF_FLAT) {
+        if (dprintf(fd, "# %u samples, %u dropped\n",
+            n, (unsigned)prof.dropped_n) < 0) ret = -1;
+    }
+
+    for (i = 0; i < n && !ret; i = j)
+    {
+        label = _label(&prof.samples[i], buf, sizeof(buf));
+
+        /* number of the thread samples */
+        for (j = i + 1;
+            j < n && !_thrd_cmp(&prof.samples[j], &prof.samples[i]); j++);
+        thrd_n = j - i;
+
+        if (fmt == COOP_PROF_FLAT) {
+            if (dprintf(fd, "%s %u %u.%u%%\n", label, thrd_n,
+                thrd_n * 100 / n, thrd_n * 1000 / n % 10) < 0) ret = -1;
+        }
+
+        /* samples per code address */
+        for (k = i; k < j && !ret; k += pc_n)
+        {
+            for (pc_n = 1; k + pc_n < j &&
+                prof.samples[k + pc_n].pc == prof.samples[k].pc; pc_n++);
+
+            if (fmt == COOP_PROF_FLAT) {
+                if (dprintf(fd, "    0x%lx %u\n",
+                    (unsigned long)prof.samples[k].pc, pc_n) < 0) ret = -1;
+            } else {
+                if (dprintf(fd, "%s;0x%lx %u\n", label,
+                    (unsigned long)prof.samples[k].pc, pc_n) < 0) ret = -1;
+            }
+        }
+    }
+
+    sigprocmask(SIG_SETMASK, &old_set, NULL);
+    return ret;
+}
+#endif /* CONFIG_OPT_UNIX_PROF */
+#endif /* __unix__ */
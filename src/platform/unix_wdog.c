@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2022 Piotr Stolarz
+ * Lightweight cooperative threads library
+ *
+ * Distributed under the 2-clause BSD License (the License)
+ * see accompanying file LICENSE for details.
+ *
+ * This software is distributed WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the License for more information.
+ */
+
+/*
+ * UNIX platform watchdog.
+ *
+ * A thread which never yields can't be caught by the scheduler. The watchdog
+ * timer is armed by the scheduler hooks on each switch to a thread and
+ * disarmed on the thread's switch out. If the timer expires, the thread hasn't
+ * returned to the scheduler within the timeout.
+ */
+
+#ifdef __unix__
+#include "coop_threads.h"
+
+#if CONFIG_OPT_UNIX_WDOG
+#if !CONFIG_OPT_HOOKS
+# error CONFIG_OPT_UNIX_WDOG requires CONFIG_OPT_HOOKS
+#endif
+
+#include <signal.h>
+#include <stdlib.h> /* abort() */
+#include <string.h> /* memset(), strlen() */
+#include <sys/time.h>
+#include <unistd.h> /* write() */
+
+static void _switch_in(unsigned thrd);
+static void _switch_out(unsigned thrd);
+static void _spawn(unsigned thrd);
+static void _terminate(unsigned thrd);
+static void _idle_enter(coop_tick_t period);
+static void _idle_exit(void);
+
+static const coop_hooks_t wdog_hooks = {
+    _switch_in, _switch_out, _spawn, _terminate, _idle_enter, _idle_exit
+};
+
+/**
+ * Watchdog context.
+ */
+static struct
+{
+    /** Watchdog started flag. */
+    bool started;
+
+    /** Hooks installed before the watchdog ones. */
+    const coop_hooks_t *prev_hooks;
+
+    /** SIGALRM action replaced by the watchdog. */
+    struct sigaction prev_act;
+
+    /** Watchdog timeout (one-shot timer value). */
+    struct itimerval itv;
+
+    /** Watchdog callback. */
+    coop_wdog_cb_t cb;
+
+    /** Currently running thread (as seen by the signal handler). */
+    volatile unsigned cur_thrd;
+    const char *volatile cur_name;
+} wdog;
+
+/**
+ * Arm (@c on is @c true) or disarm the watchdog timer.
+ *
+ * Return 0 on success, -1 on error.
+ */
+static int _timer_set(bool on)
+{
+    static const struct itimerval itv_off = {{0, 0}, {0, 0}};
+
+    return setitimer(ITIMER_REAL, (on ? &wdog.itv : &itv_off), NULL);
+}
+
+/*
+ * Scheduler hooks arming the watchdog timer for the time a thread is run.
+ * Chained to the hooks installed before the watchdog.
+ */
+static void _switch_in(unsigned thrd)
+{
+    _COOP_HOOK_CHAIN(wdog.prev_hooks, switch_in, (thrd));
+
+    wdog.cur_name = coop_thread_name();
+    wdog.cur_thrd = thrd;
+    _timer_set(true);
+}
+
+static void _switch_out(unsigned thrd)
+{
+    _timer_set(false);
+
+    _COOP_HOOK_CHAIN(wdog.prev_hooks, switch_out, (thrd));
+}
+
+static void _spawn(unsigned thrd)
+{
+    _COOP_HOOK_CHAIN(wdog.prev_hooks, spawn, (thrd));
+}
+
+static void _terminate(unsigned thrd)
+{
+    _timer_set(false);
+
+    _COOP_HOOK_CHAIN(wdog.prev_hooks, terminate, (thrd));
+}
+
+static void _idle_enter(coop_tick_t period)
+{
+    _COOP_HOOK_CHAIN(wdog.prev_hooks, idle_enter, (period));
+}
+
+static void _idle_exit(void)
+{
+    _COOP_HOOK_CHAIN(wdog.prev_hooks, idle_exit, ());
+}
+
+/**
+ * Default watchdog callback: report the thread and abort.
+ */
+static void _default_cb(unsigned thrd, const char *name)
+{
+    static const char msg[] = "coop watchdog: thread not yielding: ";
+    char buf[12], *p = &buf[sizeof(buf)];
+
+    if (write(STDERR_FILENO, msg, sizeof(msg) - 1) < 0) abort();
+    if (name) {
+        if (write(STDERR_FILENO, name, strlen(name)) < 0) abort();
+    } else {
+        /* async-signal-safe thread index formatting */
+        do { *--p = '0' + thrd % 10; } while (thrd /= 10);
+        *--p = '#';
+        if (write(STDERR_FILENO, p, &buf[sizeof(buf)] - p) < 0) abort();
+    }
+    if (write(STDERR_FILENO, "\n", 1) < 0) abort();
+    abort();
+}
+
+/**
+ * SIGALRM signal handler.
+ */
+static void _sigalrm_handler(int sig)
+{
+    (void)sig;
+    wdog.cb(wdog.cur_thrd, wdog.cur_name);
+}
+
+coop_error_t coop_wdog_start(unsigned long timeout_us, coop_wdog_cb_t cb)
+{
+    struct sigaction act;
+
+    if (!timeout_us) return COOP_ERR_INV_ARG;
+    if (wdog.started) return COOP_ERR_LIMIT;
+
+    /* SIGALRM handled by the application can't be taken over */
+    if (sigaction(SIGALRM, NULL, &act)) return COOP_ERR_INV_ARG;
+    if ((act.sa_flags & SA_SIGINFO) ||
+        (act.sa_handler != SIG_DFL && act.sa_handler != SIG_IGN))
+    {
+        return COOP_ERR_LIMIT;
+    }
+
+    memset(&wdog.itv, 0, sizeof(wdog.itv));
+    wdog.itv.it_value.tv_sec = timeout_us / 1000000LU;
+    wdog.itv.it_value.tv_usec = timeout_us % 1000000LU;
+    wdog.cb = (cb ? cb : _default_cb);
+
+    /* the timer is armed by the hooks; check it's usable */
+    if (_timer_set(false)) return COOP_ERR_INV_ARG;
+
+    /* the handler is installed before the hooks */
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = _sigalrm_handler;
+    act.sa_flags = SA_RESTART;
+    sigemptyset(&act.sa_mask);
+    if (sigaction(SIGALRM, &act, &wdog.prev_act)) return COOP_ERR_INV_ARG;
+
+    _coop_hooks_push(&wdog_hooks, &wdog.prev_hooks);
+
+    wdog.started = true;
+    return COOP_SUCCESS;
+}
+
+coop_error_t coop_wdog_stop(void)
+{
+    if (!wdog.started) return COOP_SUCCESS;
+
+    /* hooks chaining to the watchdog ones need to be uninstalled first */
+    if (_coop_hooks_pop(&wdog_hooks, wdog.prev_hooks) != COOP_SUCCESS)
+        return COOP_ERR_LIMIT;
+
+    _timer_set(false);
+    sigaction(SIGALRM, &wdog.prev_act, NULL);
+
+    wdog.started = false;
+    return COOP_SUCCESS;
+}
+#endif /* CONFIG_OPT_UNIX_WDOG */
+#endif /* __unix__ */